@@ -124,6 +124,14 @@ int Application::run()
 	en->ENcleanup();
 	en1->ENcleanup();
 
+	// round-trip statistics each coordinator derived its timeouts from, and its read latencies
+	FILE *rttFile = fopen("rtt.log", "w+");
+	for(i=0;i<=par->EN_GPSZ-1;i++) {
+		mp2[i]->getRttEstimator().writeStats(rttFile, &(mp2[i]->getMemberNode()->addr));
+		mp2[i]->writeReadStats(rttFile);
+	}
+	fclose(rttFile);
+
 	for(i=0;i<=par->EN_GPSZ-1;i++) {
 		 mp1[i]->finishUpThisNode();
 	}
@@ -392,6 +400,38 @@ int Application::findARandomNodeThatIsAlive() {
 	return number;
 }
 
+/**
+ * FUNCTION NAME: findACoordinator
+ *
+ * DESCRIPTION: Finds the node to coordinate a request on key
+ * 				With SMART_ROUTING it is a random live replica of the key, from the ring snapshot of
+ * 				a live node, so the coordinator serves its own part locally. Otherwise (or if no replica
+ * 				is alive) it is any node that is alive
+ */
+int Application::findACoordinator(const string &key) {
+	int number = findARandomNodeThatIsAlive();
+	if ( !par->SMART_ROUTING ) {
+		return number;
+	}
+	vector<Node> replicas = mp2[number]->findNodes(key);
+	vector<int> candidates;
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( mp2[i]->getMemberNode()->bFailed ) {
+			continue;
+		}
+		for ( unsigned int j = 0; j < replicas.size(); j++ ) {
+			if ( mp2[i]->getMemberNode()->addr == replicas[j].nodeAddress ) {
+				candidates.push_back(i);
+				break;
+			}
+		}
+	}
+	if ( candidates.empty() ) {
+		return number;
+	}
+	return candidates[rand()%candidates.size()];
+}
+
 /**
  * FUNCTION NAME: initTestKVPairs
  *
@@ -427,16 +467,23 @@ void Application::insertTestKVPairs() {
 	 */
 	initTestKVPairs();
 
+	// Step 1. Find a node that is alive
+	number = findARandomNodeThatIsAlive();
+
+	// Step 2. Group the keys by coordinator: the node of step 1, or a replica of each key with SMART_ROUTING
+	map<int, map<string, string> > batches;
 	for ( map<string, string>::iterator it = testKVPairs.begin(); it != testKVPairs.end(); ++it ) {
-		// Step 1. Find a node that is alive
-		number = findARandomNodeThatIsAlive();
+		int coordinator = par->SMART_ROUTING ? findACoordinator(it->first) : number;
+		log->LOG(&mp2[coordinator]->getMemberNode()->addr, "CREATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
+		batches[coordinator][it->first] = it->second;
+	}
 
-		// Step 2. Issue a create operation
-		log->LOG(&mp2[number]->getMemberNode()->addr, "CREATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
-		mp2[number]->clientCreate(it->first, it->second);
+	// Step 3. Issue the create operations, one batch per coordinator
+	for ( map<int, map<string, string> >::iterator it = batches.begin(); it != batches.end(); ++it ) {
+		mp2[it->first]->clientMultiPut(it->second);
 	}
 
-	cout<<endl<<"Sent " <<testKVPairs.size() <<" create messages to the ring"<<endl;
+	cout<<endl<<"Sent " <<testKVPairs.size() <<" creates to the ring in batches from " <<batches.size() <<" coordinator(s)"<<endl;
 }
 
 /**
@@ -455,7 +502,7 @@ void Application::deleteTest() {
 		it++;
 
 		// Step 1.a. Find a node that is alive
-		number = findARandomNodeThatIsAlive();
+		number = findACoordinator(it->first);
 
 		// Step 1.b. Issue a delete operation
 		log->LOG(&mp2[number]->getMemberNode()->addr, "DELETE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
@@ -468,7 +515,7 @@ void Application::deleteTest() {
 	cout<<endl<<"Deleting an invalid key.... ... .. . ."<<endl;
 	string invalidKey = "invalidKey";
 	// Step 2.a. Find a node that is alive
-	number = findARandomNodeThatIsAlive();
+	number = findACoordinator(invalidKey);
 
 	// Step 2.b. Issue a delete operation
 	log->LOG(&mp2[number]->getMemberNode()->addr, "DELETE OPERATION KEY: %s at time: %d", invalidKey.c_str(), par->getcurrtime());
@@ -496,7 +543,7 @@ void Application::readTest() {
  	 */
 	if ( par->getcurrtime() == TEST_TIME ) {
 		// Step 1.a. Find a node that is alive
-		number = findARandomNodeThatIsAlive();
+		number = findACoordinator(it->first);
 
 		// Step 1.b Do a read operation
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
@@ -517,7 +564,7 @@ void Application::readTest() {
 		replicas.clear();
 		replicas = mp2[number]->findNodes(it->first);
 		// if less than quorum replicas are found then exit
-		if ( replicas.size() < (RF-1) ) {
+		if ( (int)replicas.size() < (par->RF-1) ) {
 			cout<<endl<<"Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: "<<replicas.size()<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
 			exit(1);
@@ -555,7 +602,7 @@ void Application::readTest() {
 			exit(1);
 		}
 
-		number = findARandomNodeThatIsAlive();
+		number = findACoordinator(it->first);
 
 		// Step 2.d Issue a read
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
@@ -631,7 +678,7 @@ void Application::readTest() {
 				exit(1);
 			}
 
-			number = findARandomNodeThatIsAlive();
+			number = findACoordinator(it->first);
 
 			// Step 3.c Issue a read
 			cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
@@ -645,7 +692,7 @@ void Application::readTest() {
 		 */
 		// Step 3.d Wait for stabilization protocol to kick in
 		if ( par->getcurrtime() == (TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME + STABILIZE_TIME) ) {
-			number = findARandomNodeThatIsAlive();
+			number = findACoordinator(it->first);
 			// Step 3.e Issue a read
 			cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
@@ -688,7 +735,7 @@ void Application::readTest() {
 			exit(1);
 		}
 
-		number = findARandomNodeThatIsAlive();
+		number = findACoordinator(it->first);
 
 		// Step 4.d Issue a read operation
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
@@ -706,7 +753,7 @@ void Application::readTest() {
 		string invalidKey = "invalidKey";
 
 		// Step 5.a Find a node that is alive
-		number = findARandomNodeThatIsAlive();
+		number = findACoordinator(invalidKey);
 
 		// Step 5.b Issue a read operation
 		cout<<endl<<"Reading an invalid key.... ... .. . ."<<endl;
@@ -741,7 +788,7 @@ void Application::updateTest() {
 	 */
 	if ( par->getcurrtime() == TEST_TIME ) {
 		// Step 1.a. Find a node that is alive
-		number = findARandomNodeThatIsAlive();
+		number = findACoordinator(it->first);
 
 		// Step 1.b Do a update operation
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
@@ -762,7 +809,7 @@ void Application::updateTest() {
 		replicas.clear();
 		replicas = mp2[number]->findNodes(it->first);
 		// if quorum replicas are not found then exit
-		if ( replicas.size() < RF-1 ) {
+		if ( (int)replicas.size() < par->RF-1 ) {
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
 			cout<<endl<<"Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: "<<replicas.size()<<endl;
 			exit(1);
@@ -800,7 +847,7 @@ void Application::updateTest() {
 			exit(1);
 		}
 
-		number = findARandomNodeThatIsAlive();
+		number = findACoordinator(it->first);
 
 		// Step 2.d Issue a update
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
@@ -873,7 +920,7 @@ void Application::updateTest() {
 				exit(1);
 			}
 
-			number = findARandomNodeThatIsAlive();
+			number = findACoordinator(it->first);
 
 			// Step 3.c Issue an update
 			cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
@@ -887,7 +934,7 @@ void Application::updateTest() {
 		 */
 		// Step 3.d Wait for stabilization protocol to kick in
 		if ( par->getcurrtime() == (TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME + STABILIZE_TIME) ) {
-			number = findARandomNodeThatIsAlive();
+			number = findACoordinator(it->first);
 			// Step 3.e Issue a update
 			cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
@@ -931,7 +978,7 @@ void Application::updateTest() {
 			exit(1);
 		}
 
-		number = findARandomNodeThatIsAlive();
+		number = findACoordinator(it->first);
 
 		// Step 4.d Issue a update operation
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
@@ -950,7 +997,7 @@ void Application::updateTest() {
 		string invalidValue = "invalidValue";
 
 		// Step 5.a Find a node that is alive
-		number = findARandomNodeThatIsAlive();
+		number = findACoordinator(invalidKey);
 
 		// Step 5.b Issue a read operation
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
@@ -37,7 +37,6 @@ static const char alphanum[] =
 #define STABILIZE_TIME 50
 #define FIRST_FAIL_TIME 25
 #define LAST_FAIL_TIME 10
-#define RF 3
 #define NUMBER_OF_INSERTS 100
 #define KEY_LENGTH 5
 
@@ -69,6 +68,7 @@ public:
 	void fail();
 	void insertTestKVPairs();
 	int findARandomNodeThatIsAlive();
+	int findACoordinator(const string &key);
 	void deleteTest();
 	void readTest();
 	void updateTest();
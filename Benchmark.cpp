@@ -0,0 +1,211 @@
+/**********************************
+ * FILE NAME: Benchmark.cpp
+ *
+ * DESCRIPTION: Microbenchmarks of key hashing, replica lookup and placement strategies
+ * 				Build and run with "make bench"
+ **********************************/
+
+#include "stdincludes.h"
+#include "Hash.h"
+#include "Ring.h"
+#include "Placement.h"
+#include <chrono>
+
+/**
+ * Macros
+ */
+#define BENCH_KEYS 100000
+#define BENCH_ROUNDS 20
+#define BENCH_KEY_LENGTH 5
+#define BENCH_REPLICAS 3
+#define BENCH_VNODES 16
+
+static volatile uint64_t sink;
+
+/**
+ * FUNCTION NAME: makeKeys
+ *
+ * DESCRIPTION: Random alphanumeric keys shaped like the application's test keys
+ */
+static vector<string> makeKeys(int count, int length) {
+	static const char alphanum[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+	vector<string> keys(count);
+	for (int i = 0; i < count; ++i) {
+		for (int j = 0; j < length; ++j) {
+			keys[i].push_back(alphanum[rand() % (sizeof(alphanum) - 1)]);
+		}
+	}
+	return keys;
+}
+
+/**
+ * FUNCTION NAME: nsPerOp
+ *
+ * DESCRIPTION: Nanoseconds per key of fn over all keys, best of BENCH_ROUNDS
+ */
+template <class F>
+static double nsPerOp(const vector<string> &keys, F fn) {
+	double best = 1e18;
+	for (int round = 0; round < BENCH_ROUNDS; ++round) {
+		uint64_t acc = 0;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for (unsigned int i = 0; i < keys.size(); ++i) {
+			acc += fn(keys[i]);
+		}
+		chrono::steady_clock::time_point stop = chrono::steady_clock::now();
+		sink = acc;
+		best = min(best, (double)chrono::duration_cast<chrono::nanoseconds>(stop - start).count() / keys.size());
+	}
+	return best;
+}
+
+static uint64_t stdHashKey(const string &key) {
+	return std::hash<string>()(key);
+}
+
+static uint64_t wyHashKey(const string &key) {
+	return wyHash(key.data(), key.size(), HASH_SEED);
+}
+
+static uint64_t fnvHashKey(const string &key) {
+	return fnvHash(key.data(), key.size(), HASH_SEED);
+}
+
+/**
+ * FUNCTION NAME: makeMembers
+ *
+ * DESCRIPTION: Nodes addressed like the application's, id 1..count and port 0
+ */
+static vector<Node> makeMembers(int count) {
+	vector<Node> members;
+	for (int id = 1; id <= count; ++id) {
+		Address addr;
+		addr.init();
+		memcpy(&addr.addr[0], &id, sizeof(int));
+		members.push_back(Node(addr));
+	}
+	return members;
+}
+
+/**
+ * FUNCTION NAME: benchHashes
+ *
+ * DESCRIPTION: Cost of hashing one key
+ */
+static void benchHashes(const vector<string> &keys) {
+	printf("key hashing, %d byte keys (ns/key)\n", BENCH_KEY_LENGTH);
+	printf("  std::hash  %6.2f\n", nsPerOp(keys, stdHashKey));
+	printf("  wyhash     %6.2f\n", nsPerOp(keys, wyHashKey));
+	printf("  fnv-1a     %6.2f\n", nsPerOp(keys, fnvHashKey));
+}
+
+/**
+ * FUNCTION NAME: benchLookup
+ *
+ * DESCRIPTION: Cost of hashing a key and fetching its preference list
+ */
+static void benchLookup(const vector<string> &keys) {
+	int sizes[] = {10, 100, 1000};
+	int vnodes[] = {1, 16, 64};
+	printf("\nhash + preference list (ns/key)\n");
+	printf("  nodes  vnodes=1  vnodes=16  vnodes=64\n");
+	for (int s = 0; s < 3; ++s) {
+		vector<Node> members = makeMembers(sizes[s]);
+		printf("  %5d", sizes[s]);
+		for (int v = 0; v < 3; ++v) {
+			Ring ring;
+			ring.build(members, vector<int>(members.size(), vnodes[v]), BENCH_REPLICAS);
+			double ns = nsPerOp(keys, [&ring](const string &key) {
+				return (uint64_t)ring.preferenceList(hashBytes(key.data(), key.size()))[0];
+			});
+			printf("  %8.2f", ns);
+		}
+		printf("\n");
+	}
+}
+
+/**
+ * FUNCTION NAME: primaries
+ *
+ * DESCRIPTION: Primary replica of every key, as a node id
+ */
+static vector<int> primaries(Placement *placement, const vector<string> &keys) {
+	vector<int> owners(keys.size());
+	for (unsigned int i = 0; i < keys.size(); ++i) {
+		const int *list = placement->preferenceList(hashBytes(keys[i].data(), keys[i].size()));
+		owners[i] = *(int *)(&placement->member(list[0]).nodeAddress.addr);
+	}
+	return owners;
+}
+
+/**
+ * FUNCTION NAME: moved
+ *
+ * DESCRIPTION: Percentage of keys whose primary differs
+ */
+static double moved(const vector<int> &before, const vector<int> &after) {
+	int count = 0;
+	for (unsigned int i = 0; i < before.size(); ++i) {
+		count += (before[i] != after[i]);
+	}
+	return 100.0 * count / before.size();
+}
+
+/**
+ * FUNCTION NAME: benchPlacement
+ *
+ * DESCRIPTION: Lookup cost, balance and keys moved by a join or a leave for every strategy
+ * 				Balance is the largest primary share over the mean share, 1.00 is perfect.
+ * 				A join adds the node after the last id, a leave removes the middle id.
+ */
+static void benchPlacement(const vector<string> &keys) {
+	const char *names[] = {"ring", "jump", "rendezvous"};
+	placementTYPE types[] = {RING_PLACEMENT, JUMP_PLACEMENT, RENDEZVOUS_PLACEMENT};
+	int sizes[] = {10, 100};
+	printf("\nplacement strategies, %d vnodes per node\n", BENCH_VNODES);
+	printf("  strategy    nodes  ns/key  max/mean  join moved%%  leave moved%%  (ideal %%)\n");
+	for (int s = 0; s < 2; ++s) {
+		int n = sizes[s];
+		vector<Node> members = makeMembers(n);
+		vector<Node> joined = makeMembers(n + 1);
+		vector<Node> left = members;
+		left.erase(left.begin() + n / 2);
+		for (int t = 0; t < 3; ++t) {
+			Placement *placement = Placement::create(types[t]);
+			placement->build(members, vector<int>(n, BENCH_VNODES), BENCH_REPLICAS);
+			double ns = nsPerOp(keys, [placement](const string &key) {
+				return (uint64_t)placement->preferenceList(hashBytes(key.data(), key.size()))[0];
+			});
+			vector<int> base = primaries(placement, keys);
+			map<int, int> share;
+			for (unsigned int i = 0; i < base.size(); ++i) {
+				++share[base[i]];
+			}
+			int most = 0;
+			for (map<int, int>::iterator it = share.begin(); it != share.end(); ++it) {
+				most = max(most, it->second);
+			}
+			double balance = (double)most * n / keys.size();
+
+			placement->build(joined, vector<int>(n + 1, BENCH_VNODES), BENCH_REPLICAS);
+			double join = moved(base, primaries(placement, keys));
+			placement->build(left, vector<int>(n - 1, BENCH_VNODES), BENCH_REPLICAS);
+			double leave = moved(base, primaries(placement, keys));
+			delete placement;
+
+			printf("  %-10s  %5d  %6.2f  %8.2f  %11.2f  %12.2f  (%.2f)\n", names[t], n, ns, balance, join, leave, 100.0 / n);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: main
+ */
+int main(int argc, char *argv[]) {
+	srand(1);
+	vector<string> keys = makeKeys(BENCH_KEYS, BENCH_KEY_LENGTH);
+	benchHashes(keys);
+	benchLookup(keys);
+	benchPlacement(keys);
+	return SUCCESS;
+}
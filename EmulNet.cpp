@@ -12,53 +12,13 @@
 EmulNet::EmulNet(Params *p)
 {
 	//trace.funcEntry("EmulNet::EmulNet");
-	int i,j;
 	par = p;
 	emulnet.setNextId(1);
 	emulnet.settCurrBuffSize(0);
 	enInited=0;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			sent_msgs[i][j] = 0;
-			recv_msgs[i][j] = 0;
-		}
-	}
 	//trace.funcExit("EmulNet::EmulNet", SUCCESS);
 }
 
-/**
- * Copy constructor
- */
-EmulNet::EmulNet(EmulNet &anotherEmulNet) {
-	int i, j;
-	this->par = anotherEmulNet.par;
-	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
-	this->emulnet = anotherEmulNet.emulnet;
-}
-
-/**
- * Assignment operator overloading
- */
-EmulNet& EmulNet::operator =(EmulNet &anotherEmulNet) {
-	int i, j;
-	this->par = anotherEmulNet.par;
-	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
-	this->emulnet = anotherEmulNet.emulnet;
-	return *this;
-}
-
 /**
  * Destructor
  */
@@ -84,7 +44,7 @@ void *EmulNet::ENinit(Address *myaddr, short port) {
  * RETURNS:
  * size
  */
-int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+int EmulNet::ENsend(Address *myaddr, Address *toaddr, const char *data, int size, int type) {
 	en_msg *em;
 	static char temp[2048];
 	int sendmsg = rand() % 100;
@@ -93,22 +53,29 @@ int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
 		return 0;
 	}
 
-	em = (en_msg *)malloc(sizeof(en_msg) + size);
+	em = (en_msg *)pool.allocate(sizeof(en_msg) + size);
 	em->size = size;
+	em->type = type;
 
 	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
 	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->from.addr));
 	memcpy(em + 1, data, size);
 
-	emulnet.buff[emulnet.currbuffsize++] = em;
+	// queue at the tail of the destination's inbox
+	int dst = *(int *)(toaddr->addr);
+	assert(dst >= 0);
+	if (dst >= (int)emulnet.inbox.size()) {
+		emulnet.inbox.resize(dst + 1);
+	}
+	emulnet.inbox[dst].push_back(em);
+	emulnet.currbuffsize++;
 
 	int src = *(int *)(myaddr->addr);
-	int time = par->getcurrtime();
-
-	assert(src <= MAX_NODES);
-	assert(time < MAX_TIME);
+	en_tick &tick = trafficAt(src, par->getcurrtime());
 
-	sent_msgs[src][time]++;
+	tick.sent++;
+	tick.sentBytes += size;
+	countType(type, true, size);
 
 	#ifdef DEBUGLOG
 		sprintf(temp, "Sending 4+%d B msg type %d to %d.%d.%d.%d:%d ", size-4, *(int *)data, toaddr->addr[0], toaddr->addr[1], toaddr->addr[2], toaddr->addr[3], *(short *)&toaddr->addr[4]);
@@ -125,55 +92,95 @@ int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
  * RETURNS:
  * size
  */
-int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
-	char * str = (char *) malloc(data.length() * sizeof(char));
-	memcpy(str, data.c_str(), data.size());
-	int ret = this->ENsend(myaddr, toaddr, str, (data.length() * sizeof(char)));
-	free(str);
-	return ret;
+int EmulNet::ENsend(Address *myaddr, Address *toaddr, const string &data, int type) {
+	return this->ENsend(myaddr, toaddr, data.data(), data.size(), type);
 }
 
 /**
  * FUNCTION NAME: ENrecv
  *
  * DESCRIPTION: EmulNet receive function
+ * 				Drains this node's inbox in the order the messages were sent
+ * 				The payload is handed to the queue in place, the receiver owns it
+ * 				from then on and must give it back with ENfree
  *
  * RETURN:
  * 0
  */
 int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
 	// times is always assumed to be 1
-	int i;
-	char* tmp;
-	int sz;
 	en_msg *emsg;
+	int dst = *(int *)(myaddr->addr);
 
-	for( i = emulnet.currbuffsize - 1; i >= 0; i-- ) {
-		emsg = emulnet.buff[i];
-
-		if ( 0 == strcmp(emsg->to.addr, myaddr->addr) ) {
-			sz = emsg->size;
-			tmp = (char *) malloc(sz * sizeof(char));
-			memcpy(tmp, (char *)(emsg+1), sz);
+	if ( dst < 0 || dst >= (int)emulnet.inbox.size() ) {
+		return 0;
+	}
 
-			emulnet.buff[i] = emulnet.buff[emulnet.currbuffsize-1];
-			emulnet.currbuffsize--;
+	deque<en_msg *> &inbox = emulnet.inbox[dst];
+	while ( !inbox.empty() ) {
+		emsg = inbox.front();
+		inbox.pop_front();
+		emulnet.currbuffsize--;
 
-			(*enq)(queue, (char *)tmp, sz);
+		en_tick &tick = trafficAt(dst, par->getcurrtime());
+		tick.recv++;
+		tick.recvBytes += emsg->size;
+		countType(emsg->type, false, emsg->size);
 
-			free(emsg);
+		(*enq)(queue, (char *)(emsg+1), emsg->size);
+	}
 
-			int dst = *(int *)(myaddr->addr);
-			int time = par->getcurrtime();
+	return 0;
+}
 
-			assert(dst <= MAX_NODES);
-			assert(time < MAX_TIME);
+/**
+ * FUNCTION NAME: trafficAt
+ *
+ * DESCRIPTION: Counters of a node for a time unit, created on first use
+ * 				Time only moves forward, so only the last entry of a node can match
+ */
+en_tick & EmulNet::trafficAt(int node, int time) {
+	if ( node >= (int)traffic.size() ) {
+		traffic.resize(node + 1);
+	}
+	vector<en_tick> &ticks = traffic[node];
+	if ( ticks.empty() || ticks.back().time != time ) {
+		en_tick tick = {time, 0, 0, 0, 0};
+		ticks.push_back(tick);
+	}
+	return ticks.back();
+}
 
-			recv_msgs[dst][time]++;
-		}
+/**
+ * FUNCTION NAME: countType
+ *
+ * DESCRIPTION: Account a sent or received message to its type
+ */
+void EmulNet::countType(int type, bool sent, int size) {
+	if ( type == EN_UNTYPED ) {
+		return;
+	}
+	if ( type >= (int)typeStats.size() ) {
+		en_typestat zero = {0, 0, 0, 0};
+		typeStats.resize(type + 1, zero);
+	}
+	if ( sent ) {
+		typeStats[type].sent++;
+		typeStats[type].sentBytes += size;
 	}
+	else {
+		typeStats[type].recv++;
+		typeStats[type].recvBytes += size;
+	}
+}
 
-	return 0;
+/**
+ * FUNCTION NAME: ENfree
+ *
+ * DESCRIPTION: Release a payload handed out by ENrecv
+ */
+void EmulNet::ENfree(char *data) {
+	pool.release((en_msg *)data - 1);
 }
 
 /**
@@ -185,36 +192,64 @@ int EmulNet::ENcleanup() {
 	emulnet.nextid=0;
 	int i, j;
 	int sent_total, recv_total;
+	long sent_bytes, recv_bytes;
 
 	FILE* file = fopen("msgcount.log", "w+");
 
-	while(emulnet.currbuffsize > 0) {
-		free(emulnet.buff[--emulnet.currbuffsize]);
+	for ( i = 0; i < (int)emulnet.inbox.size(); i++ ) {
+		while ( !emulnet.inbox[i].empty() ) {
+			pool.release(emulnet.inbox[i].front());
+			emulnet.inbox[i].pop_front();
+		}
 	}
+	emulnet.currbuffsize = 0;
 
 	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
 		fprintf(file, "node %3d ", i);
 		sent_total = 0;
 		recv_total = 0;
+		sent_bytes = 0;
+		recv_bytes = 0;
 
+		// walk the time units, filling the ones without traffic with zeros
+		vector<en_tick> empty;
+		vector<en_tick> &ticks = (i < (int)traffic.size()) ? traffic[i] : empty;
+		unsigned int next = 0;
 		for (j = 0; j < par->getcurrtime(); j++) {
+			int sent = 0, recv = 0;
+			while (next < ticks.size() && ticks[next].time == j) {
+				sent += ticks[next].sent;
+				recv += ticks[next].recv;
+				sent_bytes += ticks[next].sentBytes;
+				recv_bytes += ticks[next].recvBytes;
+				next++;
+			}
 
-			sent_total += sent_msgs[i][j];
-			recv_total += recv_msgs[i][j];
+			sent_total += sent;
+			recv_total += recv;
 			if (i != 67) {
-				fprintf(file, " (%4d, %4d)", sent_msgs[i][j], recv_msgs[i][j]);
+				fprintf(file, " (%4d, %4d)", sent, recv);
 				if (j % 10 == 9) {
 					fprintf(file, "\n         ");
 				}
 			}
 			else {
-				fprintf(file, "special %4d %4d %4d\n", j, sent_msgs[i][j], recv_msgs[i][j]);
+				fprintf(file, "special %4d %4d %4d\n", j, sent, recv);
 			}
 		}
 		fprintf(file, "\n");
-		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n\n", i, sent_total, recv_total);
+		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n", i, sent_total, recv_total);
+		fprintf(file, "node %3d sent_bytes %8ld  recv_bytes %8ld\n\n", i, sent_bytes, recv_bytes);
 	}
 
+	for ( i = 0; i < (int)typeStats.size(); i++ ) {
+		fprintf(file, "type %2d sent %6ld  recv %6ld  sent_bytes %8ld  recv_bytes %8ld\n", i,
+				typeStats[i].sent, typeStats[i].recv, typeStats[i].sentBytes, typeStats[i].recvBytes);
+	}
+
+	fprintf(file, "pool allocs %lu releases %lu hits %lu slabs %lu oversize %lu in_use %lu\n",
+			pool.allocs, pool.releases, pool.poolHits, pool.slabCount, pool.oversize, pool.inUse());
+
 	fclose(file);
 	return 0;
 }
@@ -7,13 +7,14 @@
 #ifndef _EMULNET_H_
 #define _EMULNET_H_
 
-#define MAX_NODES 1000
-#define MAX_TIME 3600
 #define ENBUFFSIZE 30000
+// Message type of sends that do not declare one
+#define EN_UNTYPED -1
 
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include "SlabPool.h"
 
 using namespace std;
 
@@ -27,27 +28,52 @@ typedef struct en_msg {
 	Address from;
 	// Destination node
 	Address to;
+	// Message type declared by the sender, only used for statistics
+	int type;
 }en_msg;
 
+/**
+ * Struct Name: en_tick
+ *
+ * Description: Traffic of one node during one time unit
+ */
+typedef struct en_tick {
+	int time;
+	int sent;
+	int recv;
+	long sentBytes;
+	long recvBytes;
+}en_tick;
+
+/**
+ * Struct Name: en_typestat
+ *
+ * Description: Traffic of one message type over the whole run
+ */
+typedef struct en_typestat {
+	long sent;
+	long recv;
+	long sentBytes;
+	long recvBytes;
+}en_typestat;
+
 /**
  * Class Name: EM
+ *
+ * Description: Messages in flight, kept in one FIFO inbox per destination node id
  */
 class EM {
 public:
 	int nextid;
 	int currbuffsize;
 	int firsteltindex;
-	en_msg* buff[ENBUFFSIZE];
+	vector< deque<en_msg *> > inbox;
 	EM() {}
 	EM& operator = (EM &anotherEM) {
 		this->nextid = anotherEM.getNextId();
 		this->currbuffsize = anotherEM.getCurrBuffSize();
 		this->firsteltindex = anotherEM.getFirstEltIndex();
-		int i = this->currbuffsize;
-		while (i > 0) {
-			this->buff[i] = anotherEM.buff[i];
-			i--;
-		}
+		this->inbox = anotherEM.inbox;
 		return *this;
 	}
 	int getNextId() {
@@ -80,20 +106,29 @@ class EmulNet
 { 	
 private:
 	Params* par;
-	int sent_msgs[MAX_NODES + 1][MAX_TIME];
-	int recv_msgs[MAX_NODES + 1][MAX_TIME];
+	// Per node id: the time units in which it sent or received, in time order
+	vector< vector<en_tick> > traffic;
+	// Per message type
+	vector<en_typestat> typeStats;
 	int enInited;
 	EM emulnet;
+	// Message envelopes and payloads, recycled between sends
+	SlabPool pool;
 public:
  	EmulNet(Params *p);
- 	EmulNet(EmulNet &anotherEmulNet);
- 	EmulNet& operator = (EmulNet &anotherEmulNet);
  	virtual ~EmulNet();
 	void *ENinit(Address *myaddr, short port);
-	int ENsend(Address *myaddr, Address *toaddr, string data);
-	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	int ENsend(Address *myaddr, Address *toaddr, const string &data, int type = EN_UNTYPED);
+	int ENsend(Address *myaddr, Address *toaddr, const char *data, int size, int type = EN_UNTYPED);
 	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	void ENfree(char *data);
 	int ENcleanup();
+private:
+	// not copyable, the messages in flight belong to the pool of this instance
+	EmulNet(EmulNet &anotherEmulNet);
+	EmulNet& operator = (EmulNet &anotherEmulNet);
+	en_tick & trafficAt(int node, int time);
+	void countType(int type, bool sent, int size);
 };
 
 #endif /* _EMULNET_H_ */
@@ -5,37 +5,46 @@
  **********************************/
 #include "Entry.h"
 
+// delimiter of the string representation
+static const string delimiter = ":";
+
+/**
+ * constructor
+ */
+Entry::Entry(): timestamp(0), replica(PRIMARY), version() {}
+
+/**
+ * constructor
+ */
+Entry::Entry(const string &_value, int _timestamp, ReplicaType _replica): version() {
+	value = _value;
+	timestamp = _timestamp;
+	replica = _replica;
+}
+
 /**
  * constructor
  */
-Entry::Entry(string _value, int _timestamp, ReplicaType _replica){
-	this->delimiter = ":";
+Entry::Entry(const string &_value, int _timestamp, ReplicaType _replica, const Version &_version){
 	value = _value;
 	timestamp = _timestamp;
 	replica = _replica;
+	version = _version;
 }
 
 /**
  * constructor
  *
  * DESCRIPTION: Convert string to get an Entry object
+ * 				The value may contain the delimiter, so the last two fields are split off from the right
  */
-Entry::Entry(string entry){
-	vector<string> tuple;
-	this->delimiter = ":";
-	size_t pos = entry.find(delimiter);
-	size_t start = 0;
-	while (pos != string::npos) {
-		string field = entry.substr(start, pos-start);
-		tuple.push_back(field);
-		start = pos + delimiter.size();
-		pos = entry.find(delimiter, start);
-	}
-	tuple.push_back(entry.substr(start));
+Entry::Entry(string entry): version() {
+	size_t replicaPos = entry.rfind(delimiter);
+	size_t timestampPos = entry.rfind(delimiter, replicaPos - 1);
 
-	value = tuple.at(0);
-	timestamp = stoi(tuple.at(1));
-	replica = static_cast<ReplicaType>(stoi(tuple.at(2)));
+	value = entry.substr(0, timestampPos);
+	timestamp = stoi(entry.substr(timestampPos + delimiter.size(), replicaPos - timestampPos - delimiter.size()));
+	replica = static_cast<ReplicaType>(stoi(entry.substr(replicaPos + delimiter.size())));
 }
 
 /**
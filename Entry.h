@@ -4,6 +4,9 @@
  * DESCRIPTION: Header file Entry class
  **********************************/
 
+#ifndef ENTRY_H_
+#define ENTRY_H_
+
 #include "stdincludes.h"
 #include "Message.h"
 
@@ -11,15 +14,22 @@
  * CLASS NAME: Entry
  *
  * DESCRIPTION: This class describes the entry for each key in the DHT
+ * 				The hash table stores entries as typed records, the string form
+ * 				("value:timestamp:replica") is only kept for logging and debugging
  */
 class Entry{
 public:
 	string value;
 	int timestamp;
 	ReplicaType replica;
-	string delimiter;
+	// cluster-wide version of the value, timestamp is only the local time it was stored
+	Version version;
 
+	Entry();
 	Entry(string entry);
-	Entry(string _value, int _timestamp, ReplicaType _replica);
+	Entry(const string &_value, int _timestamp, ReplicaType _replica);
+	Entry(const string &_value, int _timestamp, ReplicaType _replica, const Version &_version);
 	string convertToString();
 };
+
+#endif /* ENTRY_H_ */
@@ -0,0 +1,436 @@
+/**********************************
+ * FILE NAME: FlatHashMap.h
+ *
+ * DESCRIPTION: Open-addressing hash map (Swiss-table layout)
+ **********************************/
+
+#ifndef FLATHASHMAP_H_
+#define FLATHASHMAP_H_
+
+/**
+ * Header files
+ */
+#include "stdincludes.h"
+#include <stdint.h>
+#include <new>
+#include <functional>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Macros
+ */
+// Number of control bytes compared by one probe step
+#define FHM_GROUP_WIDTH 16
+// Smallest allocated capacity, must be a power of two >= FHM_GROUP_WIDTH
+#define FHM_MIN_CAPACITY 16
+
+/**
+ * CLASS NAME: FlatHashMap
+ *
+ * DESCRIPTION: Swiss-table style hash map. All slots live in one flat array and every slot
+ * 				has a control byte holding either 7 bits of the key's hash or an EMPTY/DELETED
+ * 				marker. A lookup compares a group of 16 control bytes at once (SSE2 when
+ * 				available) and only touches the slots whose hash bits match.
+ * 				The control array carries a copy of its first group after the last slot so a
+ * 				group can be loaded at any offset without wrapping.
+ */
+template <class K, class V, class H = std::hash<K> >
+class FlatHashMap {
+public:
+	typedef pair<K, V> value_type;
+
+	/**
+	 * CLASS NAME: iterator
+	 *
+	 * DESCRIPTION: Forward iterator over the occupied slots
+	 */
+	class iterator {
+	public:
+		iterator(): owner(NULL), index(0) {}
+		iterator(const FlatHashMap *owner, size_t index): owner(owner), index(index) {
+			skipFree();
+		}
+		value_type & operator*() const {
+			return owner->slots[index];
+		}
+		value_type * operator->() const {
+			return &owner->slots[index];
+		}
+		iterator & operator++() {
+			++index;
+			skipFree();
+			return *this;
+		}
+		iterator operator++(int) {
+			iterator tmp(*this);
+			++(*this);
+			return tmp;
+		}
+		bool operator==(const iterator &another) const {
+			return index == another.index;
+		}
+		bool operator!=(const iterator &another) const {
+			return index != another.index;
+		}
+	private:
+		friend class FlatHashMap;
+		const FlatHashMap *owner;
+		size_t index;
+		void skipFree() {
+			while (index < owner->capacity && owner->ctrl[index] < 0) {
+				++index;
+			}
+		}
+	};
+	typedef iterator const_iterator;
+
+	FlatHashMap(): ctrl(NULL), slots(NULL), capacity(0), count_(0), growthLeft(0) {}
+	FlatHashMap(const FlatHashMap &another): ctrl(NULL), slots(NULL), capacity(0), count_(0), growthLeft(0) {
+		copyFrom(another);
+	}
+	FlatHashMap & operator=(const FlatHashMap &another) {
+		if (this != &another) {
+			destroy();
+			copyFrom(another);
+		}
+		return *this;
+	}
+	virtual ~FlatHashMap() {
+		destroy();
+	}
+
+	iterator begin() const {
+		return iterator(this, 0);
+	}
+	iterator end() const {
+		return iterator(this, capacity);
+	}
+	size_t size() const {
+		return count_;
+	}
+	bool empty() const {
+		return count_ == 0;
+	}
+
+	/**
+	 * FUNCTION NAME: find
+	 *
+	 * DESCRIPTION: Return an iterator to the key, or end() if absent
+	 */
+	iterator find(const K &key) const {
+		return iterator(this, lookup(key, hashOf(key)));
+	}
+
+	size_t count(const K &key) const {
+		return lookup(key, hashOf(key)) != capacity;
+	}
+
+	/**
+	 * FUNCTION NAME: emplace
+	 *
+	 * DESCRIPTION: Insert the pair unless the key exists (std::map semantics)
+	 */
+	pair<iterator, bool> emplace(const K &key, const V &value) {
+		uint64_t hash = hashOf(key);
+		size_t index = lookup(key, hash);
+		if (index != capacity) {
+			return make_pair(iterator(this, index), false);
+		}
+		index = prepareInsert(hash);
+		new (&slots[index]) value_type(key, value);
+		return make_pair(iterator(this, index), true);
+	}
+
+	V & operator[](const K &key) {
+		uint64_t hash = hashOf(key);
+		size_t index = lookup(key, hash);
+		if (index == capacity) {
+			index = prepareInsert(hash);
+			new (&slots[index]) value_type(key, V());
+		}
+		return slots[index].second;
+	}
+
+	V & at(const K &key) {
+		size_t index = lookup(key, hashOf(key));
+		assert(index != capacity);
+		return slots[index].second;
+	}
+
+	/**
+	 * FUNCTION NAME: erase
+	 *
+	 * DESCRIPTION: Remove the key, leaving a tombstone that is reclaimed on the next rehash
+	 *
+	 * RETURNS:
+	 * number of removed elements (0 or 1)
+	 */
+	size_t erase(const K &key) {
+		size_t index = lookup(key, hashOf(key));
+		if (index == capacity) {
+			return 0;
+		}
+		eraseAt(index);
+		return 1;
+	}
+
+	void erase(iterator pos) {
+		eraseAt(pos.index);
+	}
+
+	/**
+	 * FUNCTION NAME: reserve
+	 *
+	 * DESCRIPTION: Grow so that n elements fit without a rehash
+	 */
+	void reserve(size_t n) {
+		size_t cap = FHM_MIN_CAPACITY;
+		while (maxLoad(cap) < n) {
+			cap <<= 1;
+		}
+		if (cap > capacity) {
+			resize(cap);
+		}
+	}
+
+	void clear() {
+		for (size_t i = 0; i < capacity; ++i) {
+			if (ctrl[i] >= 0) {
+				slots[i].~value_type();
+			}
+		}
+		if (capacity) {
+			memset(ctrl, EMPTY, capacity + FHM_GROUP_WIDTH);
+		}
+		count_ = 0;
+		growthLeft = maxLoad(capacity);
+	}
+
+private:
+	static const int8_t EMPTY = -128;
+	static const int8_t DELETED = -2;
+
+	// control bytes: >= 0 full (low 7 hash bits), EMPTY or DELETED otherwise
+	int8_t *ctrl;
+	value_type *slots;
+	// number of slots, zero or a power of two
+	size_t capacity;
+	size_t count_;
+	// inserts into EMPTY slots left before a rehash is due
+	size_t growthLeft;
+	H hasher;
+
+	// at most 7/8 of the slots are used before growing
+	static size_t maxLoad(size_t cap) {
+		return cap - cap / 8;
+	}
+
+	uint64_t hashOf(const K &key) const {
+		// finalizer of MurmurHash3, spreads weak std::hash values over all bits
+		uint64_t hash = (uint64_t)hasher(key);
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	static int8_t h2(uint64_t hash) {
+		return (int8_t)(hash & 0x7f);
+	}
+
+	static size_t h1(uint64_t hash) {
+		return (size_t)(hash >> 7);
+	}
+
+	/**
+	 * FUNCTION NAME: matchByte
+	 *
+	 * DESCRIPTION: Bitmask of the control bytes in the group equal to b
+	 */
+	static uint32_t matchByte(const int8_t *group, int8_t b) {
+#ifdef __SSE2__
+		__m128i bytes = _mm_loadu_si128((const __m128i *)group);
+		return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(b), bytes));
+#else
+		uint32_t mask = 0;
+		for (int i = 0; i < FHM_GROUP_WIDTH; ++i) {
+			if (group[i] == b) {
+				mask |= 1u << i;
+			}
+		}
+		return mask;
+#endif
+	}
+
+	/**
+	 * FUNCTION NAME: matchFree
+	 *
+	 * DESCRIPTION: Bitmask of the EMPTY or DELETED control bytes in the group
+	 */
+	static uint32_t matchFree(const int8_t *group) {
+#ifdef __SSE2__
+		return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+		uint32_t mask = 0;
+		for (int i = 0; i < FHM_GROUP_WIDTH; ++i) {
+			if (group[i] < 0) {
+				mask |= 1u << i;
+			}
+		}
+		return mask;
+#endif
+	}
+
+	void setCtrl(size_t index, int8_t b) {
+		ctrl[index] = b;
+		// keep the cloned group after the last slot in sync
+		if (index < FHM_GROUP_WIDTH) {
+			ctrl[capacity + index] = b;
+		}
+	}
+
+	/**
+	 * FUNCTION NAME: lookup
+	 *
+	 * DESCRIPTION: Probe group by group (triangular steps) until the key or an EMPTY byte is found
+	 *
+	 * RETURNS:
+	 * slot index of the key, capacity if absent
+	 */
+	size_t lookup(const K &key, uint64_t hash) const {
+		if (count_ == 0) {
+			return capacity;
+		}
+		size_t mask = capacity - 1;
+		size_t offset = h1(hash) & mask;
+		size_t step = 0;
+		while (true) {
+			const int8_t *group = ctrl + offset;
+			uint32_t match = matchByte(group, h2(hash));
+			while (match) {
+				size_t index = (offset + __builtin_ctz(match)) & mask;
+				if (slots[index].first == key) {
+					return index;
+				}
+				match &= match - 1;
+			}
+			if (matchByte(group, EMPTY)) {
+				return capacity;
+			}
+			step += FHM_GROUP_WIDTH;
+			offset = (offset + step) & mask;
+		}
+	}
+
+	/**
+	 * FUNCTION NAME: findFree
+	 *
+	 * DESCRIPTION: First EMPTY or DELETED slot on the probe sequence of the hash
+	 */
+	size_t findFree(uint64_t hash) const {
+		size_t mask = capacity - 1;
+		size_t offset = h1(hash) & mask;
+		size_t step = 0;
+		while (true) {
+			uint32_t match = matchFree(ctrl + offset);
+			if (match) {
+				return (offset + __builtin_ctz(match)) & mask;
+			}
+			step += FHM_GROUP_WIDTH;
+			offset = (offset + step) & mask;
+		}
+	}
+
+	/**
+	 * FUNCTION NAME: prepareInsert
+	 *
+	 * DESCRIPTION: Claim a free slot for a new key, growing or purging tombstones when full
+	 *
+	 * RETURNS:
+	 * index of the claimed (still unconstructed) slot
+	 */
+	size_t prepareInsert(uint64_t hash) {
+		if (capacity == 0) {
+			resize(FHM_MIN_CAPACITY);
+		}
+		size_t index = findFree(hash);
+		if (growthLeft == 0 && ctrl[index] != DELETED) {
+			// grow when really full, rehash in place when mostly tombstones
+			if (count_ + 1 > maxLoad(capacity) / 2) {
+				resize(capacity * 2);
+			} else {
+				resize(capacity);
+			}
+			index = findFree(hash);
+		}
+		if (ctrl[index] == EMPTY) {
+			--growthLeft;
+		}
+		setCtrl(index, h2(hash));
+		++count_;
+		return index;
+	}
+
+	void eraseAt(size_t index) {
+		slots[index].~value_type();
+		setCtrl(index, DELETED);
+		--count_;
+	}
+
+	/**
+	 * FUNCTION NAME: resize
+	 *
+	 * DESCRIPTION: Move every element into a fresh table of newCapacity slots
+	 */
+	void resize(size_t newCapacity) {
+		int8_t *oldCtrl = ctrl;
+		value_type *oldSlots = slots;
+		size_t oldCapacity = capacity;
+
+		capacity = newCapacity;
+		ctrl = new int8_t[capacity + FHM_GROUP_WIDTH];
+		memset(ctrl, EMPTY, capacity + FHM_GROUP_WIDTH);
+		slots = static_cast<value_type *>(::operator new(capacity * sizeof(value_type)));
+		growthLeft = maxLoad(capacity) - count_;
+
+		for (size_t i = 0; i < oldCapacity; ++i) {
+			if (oldCtrl[i] < 0) {
+				continue;
+			}
+			uint64_t hash = hashOf(oldSlots[i].first);
+			size_t index = findFree(hash);
+			setCtrl(index, h2(hash));
+			new (&slots[index]) value_type(std::move(oldSlots[i]));
+			oldSlots[i].~value_type();
+		}
+		delete [] oldCtrl;
+		::operator delete(oldSlots);
+	}
+
+	void copyFrom(const FlatHashMap &another) {
+		if (another.count_ == 0) {
+			return;
+		}
+		reserve(another.count_);
+		for (iterator it = another.begin(); it != another.end(); ++it) {
+			emplace(it->first, it->second);
+		}
+	}
+
+	void destroy() {
+		if (capacity == 0) {
+			return;
+		}
+		clear();
+		delete [] ctrl;
+		::operator delete(slots);
+		ctrl = NULL;
+		slots = NULL;
+		capacity = 0;
+		growthLeft = 0;
+	}
+};
+
+#endif /* FLATHASHMAP_H_ */
@@ -0,0 +1,105 @@
+/**********************************
+ * FILE NAME: Hash.cpp
+ *
+ * DESCRIPTION: Stable hash functions definition
+ **********************************/
+
+#include "Hash.h"
+
+// default secret of wyhash
+static const uint64_t wySecret[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+/**
+ * FUNCTION NAME: wyMum
+ *
+ * DESCRIPTION: 64x64 -> 128 bit multiply, low half in a and high half in b
+ */
+static inline void wyMum(uint64_t &a, uint64_t &b) {
+	unsigned __int128 r = a;
+	r *= b;
+	a = (uint64_t)r;
+	b = (uint64_t)(r >> 64);
+}
+
+static inline uint64_t wyMix(uint64_t a, uint64_t b) {
+	wyMum(a, b);
+	return a ^ b;
+}
+
+static inline uint64_t read8(const uint8_t *p) {
+	uint64_t v = 0;
+	for (int i = 7; i >= 0; --i) {
+		v = (v << 8) | p[i];
+	}
+	return v;
+}
+
+static inline uint64_t read4(const uint8_t *p) {
+	return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24);
+}
+
+static inline uint64_t read3(const uint8_t *p, size_t k) {
+	return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+/**
+ * FUNCTION NAME: wyHash
+ *
+ * DESCRIPTION: wyhash (final version 4), fast on the short keys and addresses of the ring
+ */
+uint64_t wyHash(const void *data, size_t len, uint64_t seed) {
+	const uint8_t *p = (const uint8_t *)data;
+	uint64_t a, b;
+	seed ^= wyMix(seed ^ wySecret[0], wySecret[1]);
+	if (len <= 16) {
+		if (len >= 4) {
+			a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+			b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+		} else if (len > 0) {
+			a = read3(p, len);
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		size_t i = len;
+		if (i > 48) {
+			uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = wyMix(read8(p) ^ wySecret[1], read8(p + 8) ^ seed);
+				see1 = wyMix(read8(p + 16) ^ wySecret[2], read8(p + 24) ^ see1);
+				see2 = wyMix(read8(p + 32) ^ wySecret[3], read8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while (i > 16) {
+			seed = wyMix(read8(p) ^ wySecret[1], read8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		a = read8(p + i - 16);
+		b = read8(p + i - 8);
+	}
+	a ^= wySecret[1];
+	b ^= seed;
+	wyMum(a, b);
+	return wyMix(a ^ wySecret[0] ^ len, b ^ wySecret[1]);
+}
+
+/**
+ * FUNCTION NAME: fnvHash
+ *
+ * DESCRIPTION: 64-bit FNV-1a with the seed folded into the offset basis, finished with
+ * 				the MurmurHash3 mixer so nearby inputs spread over the whole ring
+ */
+uint64_t fnvHash(const void *data, size_t len, uint64_t seed) {
+	const uint8_t *p = (const uint8_t *)data;
+	uint64_t hash = 0xcbf29ce484222325ULL ^ seed;
+	for (size_t i = 0; i < len; ++i) {
+		hash ^= p[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hashMix(hash);
+}
@@ -0,0 +1,77 @@
+/**********************************
+ * FILE NAME: Hash.h
+ *
+ * DESCRIPTION: Stable hash functions for ring placement
+ **********************************/
+
+#ifndef HASH_H_
+#define HASH_H_
+
+/**
+ * Header files
+ */
+#include "stdincludes.h"
+#include <stdint.h>
+
+/**
+ * Macros
+ */
+// Hash algorithms, pick one at build time with -DHASH_ALGO=<algorithm>
+#define HASH_WY 0
+#define HASH_FNV 1
+#ifndef HASH_ALGO
+#define HASH_ALGO HASH_WY
+#endif
+// Seed shared by every node, nodes must agree on it to agree on placement
+#ifndef HASH_SEED
+#define HASH_SEED 0x6b76737472696e67ULL
+#endif
+
+/*
+ * Both functions read their input byte by byte in little-endian order, so a given
+ * seed and input hash to the same value on every platform and standard library.
+ */
+uint64_t wyHash(const void *data, size_t len, uint64_t seed);
+uint64_t fnvHash(const void *data, size_t len, uint64_t seed);
+
+/**
+ * FUNCTION NAME: hashMix
+ *
+ * DESCRIPTION: Finalizer of MurmurHash3, a bijection spreading every input bit over the result
+ */
+inline uint64_t hashMix(uint64_t hash) {
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+/**
+ * FUNCTION NAME: hashBytes
+ *
+ * DESCRIPTION: Hash with the algorithm selected by HASH_ALGO
+ */
+inline uint64_t hashBytes(const void *data, size_t len, uint64_t seed = HASH_SEED) {
+#if HASH_ALGO == HASH_FNV
+	return fnvHash(data, len, seed);
+#else
+	return wyHash(data, len, seed);
+#endif
+}
+
+/**
+ * FUNCTION NAME: valueDigest
+ *
+ * DESCRIPTION: Digest of a stored value exchanged by digest reads, 0 stands for a missing key
+ */
+inline uint64_t valueDigest(const char *data, size_t len) {
+	if (len == 0) {
+		return 0;
+	}
+	uint64_t digest = hashBytes(data, len);
+	return digest ? digest : 1;
+}
+
+#endif /* HASH_H_ */
@@ -13,15 +13,14 @@ HashTable::~HashTable() {}
 /**
  * FUNCTION NAME: create
  *
- * DESCRIPTION: This function inserts they (key,value) pair into the local hash table
+ * DESCRIPTION: This function inserts they (key,entry) pair into the local hash table
  *
  * RETURNS:
  * true on SUCCESS
- * false in FAILURE
+ * false in FAILURE (key already exists)
  */
-bool HashTable::create(string key, string value) {
-	hashTable.emplace(key, value);
-	return true;
+bool HashTable::create(const string &key, const Entry &entry) {
+	return hashTable.emplace(key, entry).second;
 }
 
 /**
@@ -30,43 +29,43 @@ bool HashTable::create(string key, string value) {
  * DESCRIPTION: This function searches for the key in the hash table
  *
  * RETURNS:
- * string value if found
+ * pointer to the stored entry if found, valid until the table is modified
  * else it returns a NULL
  */
-string HashTable::read(string key) {
-	map<string, string>::iterator search;
+Entry * HashTable::read(const string &key) {
+	HashTableStore::iterator search;
 
 	search = hashTable.find(key);
 	if ( search != hashTable.end() ) {
 		// Value found
-		return search->second;
+		return &search->second;
 	}
 	else {
 		// Value not found
-		return "";
+		return NULL;
 	}
 }
 
 /**
  * FUNCTION NAME: update
  *
- * DESCRIPTION: This function updates the given key with the updated value passed in
+ * DESCRIPTION: This function updates the given key with the updated entry passed in
  * 				if the key is found
  *
  * RETURNS:
  * true on SUCCESS
  * false on FAILURE
  */
-bool HashTable::update(string key, string newValue) {
-	map<string, string>::iterator update;
+bool HashTable::update(const string &key, const Entry &newEntry) {
+	HashTableStore::iterator update;
 
-	if (read(key).empty()) {
+	update = hashTable.find(key);
+	if ( update == hashTable.end() ) {
 		// Key not found
 		return false;
 	}
 	// Key found
-	//update = hashTable.at(key) = newValue;
-	hashTable.at(key) = newValue;
+	update->second = newEntry;
 	// Update successful
 	return true;
 }
@@ -80,18 +79,15 @@ bool HashTable::update(string key, string newValue) {
  * true on SUCCESS
  * false on FAILURE
  */
-bool HashTable::deleteKey(string key) {
-	uint eraseCount = 0;
+bool HashTable::deleteKey(const string &key) {
+	HashTableStore::iterator search;
 
-	if (read(key).empty()) {
+	search = hashTable.find(key);
+	if ( search == hashTable.end() ) {
 		// Key not found
 		return false;
 	}
-	eraseCount = hashTable.erase(key);
-	if ( eraseCount < 1 ) {
-		// Could not erase
-		return false;
-	}
+	hashTable.erase(search);
 	// Delete was successful
 	return true;
 }
@@ -138,7 +134,7 @@ void HashTable::clear() {
  * RETURNS:
  * unsigned long count (Should be always 1)
  */
-unsigned long HashTable::count(string key) {
+unsigned long HashTable::count(const string &key) {
 	return (unsigned long) hashTable.count(key);
 }
 
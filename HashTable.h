@@ -13,26 +13,45 @@
 #include "stdincludes.h"
 #include "common.h"
 #include "Entry.h"
+#include "FlatHashMap.h"
+
+/**
+ * Macros
+ */
+// Storage engines, pick one at build time with -DHT_ENGINE=<engine>
+#define HT_ENGINE_MAP 0
+#define HT_ENGINE_FLAT 1
+#ifndef HT_ENGINE
+#define HT_ENGINE HT_ENGINE_FLAT
+#endif
+
+#if HT_ENGINE == HT_ENGINE_MAP
+typedef map<string, Entry> HashTableStore;
+#else
+typedef FlatHashMap<string, Entry> HashTableStore;
+#endif
 
 /**
  * CLASS NAME: HashTable
  *
- * DESCRIPTION: This class is a wrapper to the map provided by C++ STL.
+ * DESCRIPTION: This class is a wrapper to the storage engine selected by HT_ENGINE
+ * 				(the open-addressing FlatHashMap by default, or the map provided by C++ STL).
+ * 				Keys map to typed Entry records, so no parsing happens on access.
  *
  */
 class HashTable {
 public:
-	map<string, string> hashTable;
+	HashTableStore hashTable;
 //public:
 	HashTable();
-	bool create(string key, string value);
-	string read(string key);
-	bool update(string key, string newValue);
-	bool deleteKey(string key);
+	bool create(const string &key, const Entry &entry);
+	Entry * read(const string &key);
+	bool update(const string &key, const Entry &newEntry);
+	bool deleteKey(const string &key);
 	bool isEmpty();
 	unsigned long currentSize();
 	void clear();
-	unsigned long count(string key);
+	unsigned long count(const string &key);
 	virtual ~HashTable();
 };
 
@@ -0,0 +1,77 @@
+/**********************************
+ * FILE NAME: JumpHash.cpp
+ *
+ * DESCRIPTION: JumpHash class definition
+ **********************************/
+
+#include "JumpHash.h"
+
+/**
+ * constructor
+ */
+JumpHash::JumpHash() {}
+
+/**
+ * Destructor
+ */
+JumpHash::~JumpHash() {}
+
+/**
+ * FUNCTION NAME: build
+ *
+ * DESCRIPTION: Lay out the buckets of the members in membership order
+ */
+void JumpHash::build(const vector<Node> &members, const vector<int> &vnodes, int replicas) {
+	setMembers(members, replicas);
+	buckets.clear();
+	for (unsigned int i = 0; i < members.size(); ++i) {
+		buckets.insert(buckets.end(), vnodes[i], i);
+	}
+	scratch.resize(replicas);
+}
+
+/**
+ * FUNCTION NAME: jump
+ *
+ * DESCRIPTION: Bucket in [0, buckets) of the key, only 1/n of the keys change bucket when
+ * 				the n-th bucket is added
+ */
+int JumpHash::jump(uint64_t key, int buckets) {
+	int64_t b = -1, j = 0;
+	while (j < buckets) {
+		b = j;
+		key = key * 2862933555777941757ULL + 1;
+		j = (int64_t)((b + 1) * ((double)(1LL << 31) / (double)((key >> 33) + 1)));
+	}
+	return (int)b;
+}
+
+/**
+ * FUNCTION NAME: preferenceList
+ *
+ * DESCRIPTION: Replica set of the hash: the member of the key's bucket, then the members
+ * 				of rehashed keys that are not in the set yet
+ */
+const int * JumpHash::preferenceList(uint64_t hash) {
+	if (members.empty() || (int)members.size() < replicas) {
+		return NULL;
+	}
+	int *list = &scratch[0];
+	int found = 0;
+	uint64_t key = hash;
+	for (int probe = 0; found < replicas && probe < replicas * JUMP_MAX_PROBES; ++probe) {
+		int owner = buckets[jump(key, buckets.size())];
+		if (std::find(list, list + found, owner) == list + found) {
+			list[found++] = owner;
+		}
+		key = hashMix(key + 0x9e3779b97f4a7c15ULL);
+	}
+	// heavily skewed weights can starve the probes, fill up in member order
+	for (int next = list[0] + 1; found < replicas; ++next) {
+		int owner = next % members.size();
+		if (std::find(list, list + found, owner) == list + found) {
+			list[found++] = owner;
+		}
+	}
+	return list;
+}
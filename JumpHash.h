@@ -0,0 +1,46 @@
+/**********************************
+ * FILE NAME: JumpHash.h
+ *
+ * DESCRIPTION: Header file JumpHash class
+ **********************************/
+
+#ifndef JUMPHASH_H_
+#define JUMPHASH_H_
+
+/**
+ * Header files
+ */
+#include "stdincludes.h"
+#include "Placement.h"
+
+/**
+ * Macros
+ */
+// Rehashes tried per replica before falling back to the next members in order
+#define JUMP_MAX_PROBES 32
+
+/**
+ * CLASS NAME: JumpHash
+ *
+ * DESCRIPTION: Jump consistent hash (Lamping and Veach). Member i owns vnodes[i]
+ * 				consecutive buckets and a key goes to the bucket jump() picks, further
+ * 				replicas to the buckets of rehashed keys. Needs no memory per key or token
+ * 				and balances almost perfectly, but only moves the minimum of keys when
+ * 				members are added or removed at the end of the member order.
+ */
+class JumpHash: public Placement {
+private:
+	// Member owning each bucket
+	vector<int> buckets;
+	// Preference list handed out by preferenceList()
+	vector<int> scratch;
+
+public:
+	JumpHash();
+	void build(const vector<Node> &members, const vector<int> &vnodes, int replicas);
+	const int * preferenceList(uint64_t hash);
+	static int jump(uint64_t key, int buckets);
+	virtual ~JumpHash();
+};
+
+#endif /* JUMPHASH_H_ */
@@ -10,14 +10,6 @@
 /*
  * Note: You can change/add any functions in MP1Node.{h,cpp}
  */
-static bool compMemberEntry(const MemberListEntry &lhs, const MemberListEntry &rhs) {
-	if (lhs.id == rhs.id) {
-		return lhs.port < rhs.port;
-	} else {
-		return lhs.id < rhs.id;
-	}
-}
-
 /**
  * Overloaded Constructor of the MP1Node class
  * You can add new members to the class if you think it
@@ -110,8 +102,7 @@ int MP1Node::initThisNode(Address *joinaddr) {
 	int myID = *(int*)(&memberNode->addr.addr);
 	int myPort = *(short*)(&memberNode->addr.addr[4]);
 	MemberListEntry myself(myID, myPort, memberNode->heartbeat, memberNode->heartbeat);
-	memberNode->memberList.push_back(myself);
-	++(memberNode->nnb);
+	memberNode->addMember(myself);
 	log->logNodeAdd(&memberNode->addr, &memberNode->addr);
 	return 0;
 }
@@ -140,7 +131,7 @@ log->LOG(&memberNode->addr, "Starting up group...");
 log->LOG(&memberNode->addr, "Trying to join...");
 #endif
 		// send JOINREQ message to introducer member
-		emulNet->ENsend(&memberNode->addr, joinaddr, (char *)msg, msgsize);
+		emulNet->ENsend(&memberNode->addr, joinaddr, (char *)msg, msgsize, JOINREQ);
 		free(msg);
 	}
 
@@ -193,6 +184,7 @@ void MP1Node::checkMessages() {
 		size = memberNode->mp1q.front().size;
 		memberNode->mp1q.pop();
 		recvCallBack((void *)memberNode, (char *)ptr, size);
+		emulNet->ENfree((char *)ptr);
 	}
 	return;
 }
@@ -213,32 +205,27 @@ bool MP1Node::recvCallBack(void *env, char *data, int size ) {
 		sendMemberList(JOINREP, &recvAddr, nofail);
 		// add the new process into membership list
 		long recvHb = *(long *)(data + sizeof(MessageHdr) + sizeof(recvAddr.addr) + 1);
-		int recvID = *(int *)&recvAddr.addr;
-		short recvPort = *(short *)&recvAddr.addr[4];
-		MemberListEntry recvEntry(recvID, recvPort, recvHb, memberNode->heartbeat);
-		memberNode->memberList.push_back(recvEntry);
-		++(memberNode->nnb);
-		log->logNodeAdd(&memberNode->addr, &recvAddr);
-	} else if (recvMsg->msgType == JOINREP) {
-		if (memberNode->inGroup == false) {
+		updateMemberList(recvAddr, recvHb);
+	} else {
+		if (recvMsg->msgType == JOINREP && memberNode->inGroup == false) {
 			memberNode->inGroup = true;
 			log->LOG(&memberNode->addr, "Joining the group...");
 		}
-		// fetch membership list information from the message
-		Address entryAddr;
-		memcpy(&entryAddr.addr, data + sizeof(MessageHdr), sizeof(entryAddr.addr));
-		long entryHb = *(long *)(data + sizeof(MessageHdr) + sizeof(entryAddr.addr) + 1);
-		// add received member entry into membership list
-		updateMemberList(entryAddr, entryHb);	
-	} else {
-		// fetch heartbeat update information from the message
-		Address updateAddr;
-		memcpy(&updateAddr.addr, data + sizeof(MessageHdr), sizeof(updateAddr.addr));
-		long updateHb = *(long *)(data + sizeof(MessageHdr) + sizeof(updateAddr.addr) + 1);
-		// update membership list with gossip heartbeat
-		updateMemberList(updateAddr, updateHb);	
+		// JOINREP carries the introducer's membership list, GOSSIPHB a peer's heartbeats
+		char *pos = data + sizeof(MessageHdr);
+		char *end = data + size;
+		int count;
+		memcpy(&count, pos, sizeof(int));
+		pos += sizeof(int);
+		for (int i = 0; i < count && pos + MEMBER_ENTRY_SIZE <= end; ++i) {
+			Address entryAddr;
+			long entryHb;
+			memcpy(&entryAddr.addr, pos, sizeof(entryAddr.addr));
+			memcpy(&entryHb, pos + sizeof(entryAddr.addr), sizeof(long));
+			pos += MEMBER_ENTRY_SIZE;
+			updateMemberList(entryAddr, entryHb);
+		}
 	}
-	free(recvMsg);
 	return true;
 }
 
@@ -246,26 +233,47 @@ bool MP1Node::recvCallBack(void *env, char *data, int size ) {
  * FUNCTION NAME: sendMemberList
  *
  * DESCRIPTION: Send member list entries not listed in the blacklist to the destination
+ * 				Entries are packed into as few messages as MAX_MSG_SIZE allows,
+ * 				one message for any realistic group size
  */
-void MP1Node::sendMemberList(const MsgTypes type, Address *destAddr, set<int> invalid) {
+void MP1Node::sendMemberList(const MsgTypes type, Address *destAddr, const set<int> &invalid) {
+	size_t headerSize = sizeof(MessageHdr) + sizeof(int);
+	int perMsg = (par->MAX_MSG_SIZE - (int)sizeof(en_msg) - (int)headerSize - 1) / (int)MEMBER_ENTRY_SIZE;
+	int total = memberNode->memberList.size() - invalid.size();
+	if (perMsg > total) {
+		perMsg = total;
+	}
+	if (perMsg <= 0) {
+		return;
+	}
+	char *sendMsg = (char *)malloc(headerSize + perMsg * MEMBER_ENTRY_SIZE);
+	((MessageHdr *)sendMsg)->msgType = type;
+	char *pos = sendMsg + headerSize;
+	int count = 0;
 	for (vector<MemberListEntry>::iterator iter = memberNode->memberList.begin();
 		iter != memberNode->memberList.end(); ++iter) {
 		if (invalid.count(iter - memberNode->memberList.begin())) {
 			continue;
 		}
-		MessageHdr *sendMsg;
-		size_t sendMsgSize = sizeof(MessageHdr) + sizeof(Address) + sizeof(long) + 1;
-		sendMsg = (MessageHdr *)malloc(sendMsgSize * sizeof(char));
-		sendMsg->msgType = type;
 		Address entryAddr;
 		memset(&entryAddr, 0, sizeof(Address));
 		*(int *)(&entryAddr.addr) = iter->id;
 		*(short *)(&entryAddr.addr[4]) = iter->port;
-		memcpy((char *)(sendMsg+1), &entryAddr.addr, sizeof(entryAddr.addr));
-		memcpy((char *)(sendMsg+1) + 1 + sizeof(entryAddr.addr), &iter->heartbeat, sizeof(long));
-		emulNet->ENsend(&memberNode->addr, destAddr, (char *)sendMsg, sendMsgSize);
-		free(sendMsg);
+		memcpy(pos, &entryAddr.addr, sizeof(entryAddr.addr));
+		memcpy(pos + sizeof(entryAddr.addr), &iter->heartbeat, sizeof(long));
+		pos += MEMBER_ENTRY_SIZE;
+		if (++count == perMsg) {
+			memcpy(sendMsg + sizeof(MessageHdr), &count, sizeof(int));
+			emulNet->ENsend(&memberNode->addr, destAddr, sendMsg, pos - sendMsg, type);
+			pos = sendMsg + headerSize;
+			count = 0;
+		}
+	}
+	if (count) {
+		memcpy(sendMsg + sizeof(MessageHdr), &count, sizeof(int));
+		emulNet->ENsend(&memberNode->addr, destAddr, sendMsg, pos - sendMsg, type);
 	}
+	free(sendMsg);
 }
 
 /**
@@ -276,24 +284,18 @@ void MP1Node::sendMemberList(const MsgTypes type, Address *destAddr, set<int> in
 void MP1Node::updateMemberList(Address updAddr, long updHb) {
 	int updateID = *(int *)&updAddr.addr;
 	short updatePort = *(short *)&updAddr.addr[4];
-	bool exist(false);
-	// update current entry if member already exist
-	for (vector<MemberListEntry>::iterator iter = memberNode->memberList.begin();
-		iter != memberNode->memberList.end(); ++iter) {
-		if (updateID == iter->id && updatePort == iter->port) {
-			exist = true;
-			if (updHb > iter->heartbeat) {
-				iter->heartbeat = updHb;
-				iter->timestamp = memberNode->heartbeat;
-			}
-			break;
+	int index = memberNode->findMember(updateID, updatePort);
+	if (index >= 0) {
+		// update current entry if member already exist
+		MemberListEntry &entry = memberNode->memberList[index];
+		if (updHb > entry.heartbeat) {
+			entry.heartbeat = updHb;
+			entry.timestamp = memberNode->heartbeat;
 		}
-	}
-	// insert the entry as a new member if not found
-	if (exist == false) {
+	} else {
+		// insert the entry as a new member if not found
 		MemberListEntry updateEntry(updateID, updatePort, updHb, memberNode->heartbeat);
-		memberNode->memberList.push_back(updateEntry);
-		++(memberNode->nnb);
+		memberNode->addMember(updateEntry);
 		log->logNodeAdd(&memberNode->addr, &updAddr);
 	}
 }
@@ -310,50 +312,32 @@ void MP1Node::nodeLoopOps() {
 	if (memberNode->inGroup == false) {
 		return;
 	}
-	// Sort entire membership list and update self pointer
-	if (memberNode->memberList.size()) {
-		// Sort the membership list based on process address
-		sort(memberNode->memberList.begin(), memberNode->memberList.end(), compMemberEntry);
-		// update self-pointer to map the right entry in membership list
-		int myID = *(int *)&memberNode->addr.addr;
-		int myPort = *(short *)&memberNode->addr.addr[4];
-		for (vector<MemberListEntry>::iterator iter = memberNode->memberList.begin();
-						iter != memberNode->memberList.end(); ++iter) {
-			if (myID == iter->id && myPort == iter->port) {
-				memberNode->myPos = iter;
-			}
+	// remove members whose heartbeat timeout for TREMOVE, keeping the list ordered
+	vector<MemberListEntry> &memberList = memberNode->memberList;
+	vector<int> removed;
+	for (unsigned int i = 0; i < memberList.size(); ++i) {
+		if (memberList[i].timestamp >= (memberNode->heartbeat - TREMOVE)) {
+			continue;
 		}
+		Address removeAddr;
+		memset(&removeAddr, 0, sizeof(Address));
+		*(int *)(&removeAddr.addr) = memberList[i].id;
+		*(short *)(&removeAddr.addr[4]) = memberList[i].port;
+		log->logNodeRemove(&memberNode->addr, &removeAddr);
+		removed.push_back(i);
+	}
+	// from the back, so the indices still to remove do not move
+	for (int i = (int)removed.size() - 1; i >= 0; --i) {
+		memberNode->removeMember(removed[i]);
 	}
-	// check all membership and remove if anyone timeout for 2 * TFAIL, mark if anyone timeout for TFAIL
-	int last(memberNode->nnb - 1), index(0);
+	// mark members whose heartbeat timeout for TFAIL, they are not gossiped
+	int index(0);
 	set<int> fails;
-	while (index <= last) {
-		if (memberNode->memberList[index].timestamp >= (memberNode->heartbeat - TFAIL)) {
-			// member's heartbeat period is in range
-			++index;
-		} else if (memberNode->memberList[index].timestamp >= (memberNode->heartbeat - TREMOVE)) {
-			// member's heartbeat already timeout for TFAIL but not reach TREMOVE 
+	for (index = 0; index < memberNode->nnb; ++index) {
+		if (memberList[index].timestamp < (memberNode->heartbeat - TFAIL)) {
 			fails.insert(index);
-			++index;
-		} else {
-			// member's heartbeat timeout for TREMOVE 
-			MemberListEntry tmp = memberNode->memberList[last];
-			memberNode->memberList[last] = memberNode->memberList[index];
-			memberNode->memberList[index] = tmp;
-			--last;
 		}
 	}
-	// remove failures
-	int rmCnt(memberNode->nnb - 1 - last); 
-	for (int i = 0; i < rmCnt; ++i) {
-		Address removeAddr;
-		memset(&removeAddr, 0, sizeof(Address));
-		*(int *)(&removeAddr.addr) = memberNode->memberList.back().id;
-		*(short *)(&removeAddr.addr[4]) = memberNode->memberList.back().port;
-		memberNode->memberList.pop_back();
-		--(memberNode->nnb);
-		log->logNodeRemove(&memberNode->addr, &removeAddr);
-	}
 	// gossip membership list entries to 3 random nodes, skip member if it timeout for TFAIL
 	set<int> destIndex;
 	int sdCnt(0), myIndex;
@@ -407,7 +391,7 @@ Address MP1Node::getJoinAddress() {
  * DESCRIPTION: Initialize the membership list
  */
 void MP1Node::initMemberListTable(Member *memberNode) {
-	memberNode->memberList.clear();
+	memberNode->clearMembers();
 }
 
 /**
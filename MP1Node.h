@@ -21,6 +21,8 @@
  */
 #define TREMOVE 20
 #define TFAIL 5
+// Bytes of one membership entry in JOINREP/GOSSIPHB: address followed by heartbeat
+#define MEMBER_ENTRY_SIZE (6 + sizeof(long))
 
 /*
  * Note: You can change/add any functions in MP1Node.{h,cpp}
@@ -39,6 +41,8 @@ enum MsgTypes{
  * STRUCT NAME: MessageHdr
  *
  * DESCRIPTION: Header and content of a message
+ * 				JOINREQ: {address, heartbeat}
+ * 				JOINREP, GOSSIPHB: {int count, count * {address, heartbeat}}
  */
 typedef struct MessageHdr {
 	enum MsgTypes msgType;
@@ -56,7 +60,7 @@ private:
 	Params *par;
 	Member *memberNode;
 	char NULLADDR[6];
-	void sendMemberList(const MsgTypes type, Address *destAddr, set<int> invalid);
+	void sendMemberList(const MsgTypes type, Address *destAddr, const set<int> &invalid);
 	void updateMemberList(Address updAddr, long updHb);
 
 public:
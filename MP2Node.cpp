@@ -15,6 +15,11 @@ MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet * emulNet, Log * log,
 	this->log = log;
 	ht = new HashTable();
 	this->memberNode->addr = *address;
+	this->ringVersion = ~0UL;
+	this->ring = Placement::create(par->PLACEMENT);
+	this->prevRing = Placement::create(par->PLACEMENT);
+	memset(&readStats, 0, sizeof(readStats));
+	this->clock = Version();
 }
 
 /**
@@ -22,6 +27,8 @@ MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet * emulNet, Log * log,
  */
 MP2Node::~MP2Node() {
 	delete ht;
+	delete ring;
+	delete prevRing;
 	delete memberNode;
 }
 
@@ -40,6 +47,12 @@ void MP2Node::updateRing() {
 	 */
 	vector<Node> curMemList;
 
+	// nobody joined or left since the last call, the ring is still valid
+	if (ringVersion == memberNode->memberVersion) {
+		return;
+	}
+	ringVersion = memberNode->memberVersion;
+
 	/*
 	 *  Step 1. Get the current membership list from Membership Protocol / MP1
 	 */
@@ -48,9 +61,15 @@ void MP2Node::updateRing() {
 	/*
 	 * Step 2: Construct the ring
 	 */
-	// Sort the list based on the hashCode and update ring
-	sort(curMemList.begin(), curMemList.end());
-	ring = curMemList;
+	// Place the virtual nodes of every member and precompute the replicas of every range
+	vector<int> vnodes;
+	for (unsigned int i = 0; i < curMemList.size(); ++i) {
+		vnodes.push_back(par->getvnodes(*(int *)(&curMemList[i].nodeAddress.addr)));
+	}
+	delete prevRing;
+	prevRing = ring;
+	ring = Placement::create(par->PLACEMENT);
+	ring->build(curMemList, vnodes, par->RF);
 
 	/*
 	 * Step 3: Run the stabilization protocol IF REQUIRED
@@ -72,6 +91,7 @@ void MP2Node::updateRing() {
 vector<Node> MP2Node::getMembershipList() {
 	unsigned int i;
 	vector<Node> curMemList;
+	curMemList.reserve(this->memberNode->memberList.size());
 	for ( i = 0 ; i < this->memberNode->memberList.size(); i++ ) {
 		Address addressOfThisMember;
 		int id = this->memberNode->memberList.at(i).getid();
@@ -90,12 +110,10 @@ vector<Node> MP2Node::getMembershipList() {
  * 				HASH FUNCTION USED FOR CONSISTENT HASHING
  *
  * RETURNS:
- * size_t position on the ring
+ * uint64_t position on the 64-bit ring
  */
-size_t MP2Node::hashFunction(string key) {
-	std::hash<string> hashFunc;
-	size_t ret = hashFunc(key);
-	return ret%RING_SIZE;
+uint64_t MP2Node::hashFunction(const string &key) {
+	return hashBytes(key.data(), key.size());
 }
 
 /**
@@ -106,18 +124,34 @@ size_t MP2Node::hashFunction(string key) {
  * 				1) Constructs the message
  * 				2) Finds the replicas of this key
  * 				3) Sends a message to the replica
+ * 				The request completes once level replicas replied (DEFAULT_LEVEL: see Params)
  */
-void MP2Node::clientCreate(string key, string value) {
-	// find the 3 nodes on the virtual ring and send the CREATE message
-	vector<Node> nodes = findNodes(key);
-	dispatchMessages(&(nodes[0].nodeAddress), Message(g_transID, memberNode->addr, CREATE, key, value, PRIMARY));
-	dispatchMessages(&(nodes[1].nodeAddress), Message(g_transID, memberNode->addr, CREATE, key, value, SECONDARY));
-	dispatchMessages(&(nodes[2].nodeAddress), Message(g_transID, memberNode->addr, CREATE, key, value, TERTIARY));
+void MP2Node::clientCreate(string key, string value, ConsistencyLevel level) {
+	// find the RF nodes on the virtual ring and send the CREATE message
+	const int *nodes = ring->preferenceList(hashFunction(key));
+	if (!nodes) {
+		// fewer members than replicas, the request cannot reach its replicas
+		logCoordinatorFail(CREATE, g_transID++, key, value);
+		return;
+	}
+	vector<Address *> replicas;
+	for (int i = 0; i < par->RF; ++i) {
+		replicas.push_back(&(ring->member(nodes[i]).nodeAddress));
+	}
 	// log coordinate request
-	timeoutBook[g_transID] = vector<long>({memberNode->heartbeat, 3, 0});
-	Message rqstMsg(g_transID, memberNode->addr, CREATE, key, value);
-	replyBook[g_transID].push_back(rqstMsg.toString());
+	Transaction *trans = openTransaction(CREATE, key, value, replicas, par->getquorum(level, false));
 	++g_transID;
+	Version version = nextVersion();
+	bool local(false);
+	for (int i = 0; i < par->RF; ++i) {
+		Message rqst(trans->transID, memberNode->addr, CREATE, key, value, static_cast<ReplicaType>(i));
+		rqst.version = version;
+		local |= sendRequest(trans, replicas[i], rqst);
+	}
+	if (local) {
+		checkStatus(trans);
+	}
+	flushOutbox();
 }
 
 /**
@@ -128,18 +162,60 @@ void MP2Node::clientCreate(string key, string value) {
  * 				1) Constructs the message
  * 				2) Finds the replicas of this key
  * 				3) Sends a message to the replica
+ * 				The request completes once level replicas replied (DEFAULT_LEVEL: see Params)
  */
-void MP2Node::clientRead(string key){
-	// find the 3 nodes on the virtual ring and send the READ message
-	vector<Node> nodes = findNodes(key);
-	dispatchMessages(&(nodes[0].nodeAddress), Message(g_transID, memberNode->addr, READ, key));
-	dispatchMessages(&(nodes[1].nodeAddress), Message(g_transID, memberNode->addr, READ, key));
-	dispatchMessages(&(nodes[2].nodeAddress), Message(g_transID, memberNode->addr, READ, key));
+void MP2Node::clientRead(string key, ConsistencyLevel level){
+	// find the RF nodes on the virtual ring and send the READ message
+	const int *nodes = ring->preferenceList(hashFunction(key));
+	if (!nodes) {
+		// fewer members than replicas, the request cannot reach its replicas
+		logCoordinatorFail(READ, g_transID++, key, "");
+		return;
+	}
+	int quorum = par->getquorum(level, true);
+	vector<Address *> replicas;
+	for (int i = 0; i < par->RF; ++i) {
+		replicas.push_back(&(ring->member(nodes[i]).nodeAddress));
+	}
+	// Speculative read: ask the quorum fastest replicas, keep the others to hedge to.
+	// This node answers without a round trip, it always comes first
+	vector<Address *> spares;
+	if (par->HEDGED_READS) {
+		RttEstimator &estimator = rtts;
+		Address *self = &(memberNode->addr);
+		stable_sort(replicas.begin(), replicas.end(), [&estimator, self](Address *a, Address *b) {
+			long latencyA = (*a == *self) ? 0 : estimator.latency(a, READ);
+			long latencyB = (*b == *self) ? 0 : estimator.latency(b, READ);
+			return latencyA < latencyB;
+		});
+		spares.assign(replicas.begin() + quorum, replicas.end());
+		replicas.resize(quorum);
+	}
 	// log coordinate request
-	timeoutBook[g_transID] = vector<long>({memberNode->heartbeat, 3, 0});
-	Message rqstMsg(g_transID, memberNode->addr, READ, key);
-	replyBook[g_transID].push_back(rqstMsg.toString());
+	Transaction *trans = openTransaction(READ, key, "", replicas, quorum);
+	++readStats.reads;
+	if (spares.size()) {
+		long wait = 0;
+		for (Address *replica : replicas) {
+			wait = max(wait, rtts.percentile(replica, READ, par->HEDGE_PERCENTILE));
+		}
+		for (Address *spare : spares) {
+			trans->addSpare(spare);
+		}
+		armHedge(trans, wait);
+	}
 	++g_transID;
+	bool local(false);
+	for (unsigned int i = 0; i < replicas.size(); ++i) {
+		Message rqst(trans->transID, memberNode->addr, READ, key);
+		// Digest read: only the first (fastest when speculative) replica sends the value back
+		rqst.digestOnly = par->DIGEST_READS && i > 0;
+		local |= sendRequest(trans, replicas[i], rqst);
+	}
+	if (local) {
+		checkStatus(trans);
+	}
+	flushOutbox();
 }
 
 /**
@@ -150,18 +226,34 @@ void MP2Node::clientRead(string key){
  * 				1) Constructs the message
  * 				2) Finds the replicas of this key
  * 				3) Sends a message to the replica
+ * 				The request completes once level replicas replied (DEFAULT_LEVEL: see Params)
  */
-void MP2Node::clientUpdate(string key, string value){
-	// find the 3 nodes on the virtual ring and send the UPDATE message
-	vector<Node> nodes = findNodes(key);
-	dispatchMessages(&(nodes[0].nodeAddress), Message(g_transID, memberNode->addr, UPDATE, key, value, PRIMARY));
-	dispatchMessages(&(nodes[1].nodeAddress), Message(g_transID, memberNode->addr, UPDATE, key, value, SECONDARY));
-	dispatchMessages(&(nodes[2].nodeAddress), Message(g_transID, memberNode->addr, UPDATE, key, value, TERTIARY));
+void MP2Node::clientUpdate(string key, string value, ConsistencyLevel level){
+	// find the RF nodes on the virtual ring and send the UPDATE message
+	const int *nodes = ring->preferenceList(hashFunction(key));
+	if (!nodes) {
+		// fewer members than replicas, the request cannot reach its replicas
+		logCoordinatorFail(UPDATE, g_transID++, key, value);
+		return;
+	}
+	vector<Address *> replicas;
+	for (int i = 0; i < par->RF; ++i) {
+		replicas.push_back(&(ring->member(nodes[i]).nodeAddress));
+	}
 	// log coordinate request
-	timeoutBook[g_transID] = vector<long>({memberNode->heartbeat, 3, 0});
-	Message rqstMsg(g_transID, memberNode->addr, UPDATE, key, value);
-	replyBook[g_transID].push_back(rqstMsg.toString());
+	Transaction *trans = openTransaction(UPDATE, key, value, replicas, par->getquorum(level, false));
 	++g_transID;
+	Version version = nextVersion();
+	bool local(false);
+	for (int i = 0; i < par->RF; ++i) {
+		Message rqst(trans->transID, memberNode->addr, UPDATE, key, value, static_cast<ReplicaType>(i));
+		rqst.version = version;
+		local |= sendRequest(trans, replicas[i], rqst);
+	}
+	if (local) {
+		checkStatus(trans);
+	}
+	flushOutbox();
 }
 
 /**
@@ -172,18 +264,163 @@ void MP2Node::clientUpdate(string key, string value){
  * 				1) Constructs the message
  * 				2) Finds the replicas of this key
  * 				3) Sends a message to the replica
+ * 				The request completes once level replicas replied (DEFAULT_LEVEL: see Params)
  */
-void MP2Node::clientDelete(string key){
-	// find the 3 nodes on the virtual ring and send the DELETE message
-	vector<Node> nodes = findNodes(key);
-	dispatchMessages(&(nodes[0].nodeAddress), Message(g_transID, memberNode->addr, DELETE, key));
-	dispatchMessages(&(nodes[1].nodeAddress), Message(g_transID, memberNode->addr, DELETE, key));
-	dispatchMessages(&(nodes[2].nodeAddress), Message(g_transID, memberNode->addr, DELETE, key));
+void MP2Node::clientDelete(string key, ConsistencyLevel level){
+	// find the RF nodes on the virtual ring and send the DELETE message
+	const int *nodes = ring->preferenceList(hashFunction(key));
+	if (!nodes) {
+		// fewer members than replicas, the request cannot reach its replicas
+		logCoordinatorFail(DELETE, g_transID++, key, "");
+		return;
+	}
+	vector<Address *> replicas;
+	for (int i = 0; i < par->RF; ++i) {
+		replicas.push_back(&(ring->member(nodes[i]).nodeAddress));
+	}
 	// log coordinate request
-	timeoutBook[g_transID] = vector<long>({memberNode->heartbeat, 3, 0});
-	Message rqstMsg(g_transID, memberNode->addr, DELETE, key);
-	replyBook[g_transID].push_back(rqstMsg. toString());
+	Transaction *trans = openTransaction(DELETE, key, "", replicas, par->getquorum(level, false));
+	++g_transID;
+	bool local(false);
+	for (Address *replica : replicas) {
+		local |= sendRequest(trans, replica, Message(trans->transID, memberNode->addr, DELETE, key));
+	}
+	if (local) {
+		checkStatus(trans);
+	}
+	flushOutbox();
+}
+
+/**
+ * FUNCTION NAME: logCoordinatorFail
+ *
+ * DESCRIPTION: Log the failure of a request this node coordinates
+ */
+void MP2Node::logCoordinatorFail(MessageType type, int transID, const string &key, const string &value) {
+	switch (type) {
+		case CREATE:
+			log->logCreateFail(&(memberNode->addr), true, transID, key, value);
+			break;
+		case READ:
+			log->logReadFail(&(memberNode->addr), true, transID, key);
+			break;
+		case UPDATE:
+			log->logUpdateFail(&(memberNode->addr), true, transID, key, value);
+			break;
+		case DELETE:
+			log->logDeleteFail(&(memberNode->addr), true, transID, key);
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * FUNCTION NAME: clientMultiGet
+ *
+ * DESCRIPTION: client side batch READ API
+ * 				Reads every key like clientRead (without hedging, digests or read repair),
+ * 				every replica gets one message for all the keys it holds
+ */
+void MP2Node::clientMultiGet(const vector<string> &keys, ConsistencyLevel level) {
+	vector<pair<string, string> > pairs;
+	pairs.reserve(keys.size());
+	for (const string &key : keys) {
+		pairs.push_back(make_pair(key, string("")));
+	}
+	clientBatch(READ, pairs, level);
+}
+
+/**
+ * FUNCTION NAME: clientMultiPut
+ *
+ * DESCRIPTION: client side batch CREATE API
+ * 				Creates every pair like clientCreate, every replica gets one message for all the
+ * 				keys it holds
+ */
+void MP2Node::clientMultiPut(const map<string, string> &pairs, ConsistencyLevel level) {
+	clientBatch(CREATE, vector<pair<string, string> >(pairs.begin(), pairs.end()), level);
+}
+
+/**
+ * FUNCTION NAME: clientBatch
+ *
+ * DESCRIPTION: Send a sub-operation of the given type for every pair to the replicas of its key
+ * 				The function does the following:
+ * 				1) Groups the sub-operations by replica, a replica gets more than one BATCH
+ * 				   only when they do not fit in one network message
+ * 				2) Opens one batch transaction tracking the replies per key
+ * 				3) Sends the batches, serving the one of this node locally
+ * 				Every key completes on its own once level replicas replied (DEFAULT_LEVEL: see Params)
+ */
+void MP2Node::clientBatch(MessageType type, const vector<pair<string, string> > &pairs, ConsistencyLevel level) {
+	if (pairs.empty()) {
+		return;
+	}
+	// Replicas of every key (copied, preferenceList() may reuse its buffer) and the
+	// distinct replicas of the batch
+	vector<int> preferences(pairs.size() * par->RF);
+	vector<Address *> replicas;
+	map<int, int> slots;
+	for (unsigned int k = 0; k < pairs.size(); ++k) {
+		const int *nodes = ring->preferenceList(hashFunction(pairs[k].first));
+		if (!nodes) {
+			// fewer members than replicas, no key of the batch can reach its replicas
+			for (const pair<string, string> &failed : pairs) {
+				logCoordinatorFail(type, g_transID, failed.first, failed.second);
+			}
+			++g_transID;
+			return;
+		}
+		copy(nodes, nodes + par->RF, preferences.begin() + k * par->RF);
+		for (int i = 0; i < par->RF; ++i) {
+			if (slots.insert(make_pair(nodes[i], (int)replicas.size())).second) {
+				replicas.push_back(&(ring->member(nodes[i]).nodeAddress));
+			}
+		}
+	}
+	// log coordinate request, the batch fails once its slowest replica is late
+	Transaction *trans = openTransaction(BATCH, "", "", replicas, replicas.size());
+	trans->quorum = par->getquorum(level, type == READ);
 	++g_transID;
+	Version version = nextVersion();
+	vector<Message> batches(replicas.size(), Message(trans->transID, memberNode->addr, BATCH));
+	vector<int> sizes(replicas.size(), 0);
+	int capacity = batchCapacity();
+	bool local(false);
+	for (unsigned int k = 0; k < pairs.size(); ++k) {
+		const string &key = pairs[k].first;
+		const string &value = pairs[k].second;
+		int index = trans->addKey(type, key, value, par->RF);
+		int size = key.size() + value.size() + BATCH_OP_OVERHEAD;
+		for (int i = 0; i < par->RF; ++i) {
+			int slot = slots[preferences[k * par->RF + i]];
+			Message &batch = batches[slot];
+			if (batch.ops.size() && sizes[slot] + size > capacity) {
+				local |= sendRequest(trans, replicas[slot], batch);
+				batch.ops.clear();
+				sizes[slot] = 0;
+			}
+			batch.addOp(type, static_cast<ReplicaType>(i), index, false, key, value, (type == READ) ? Version() : version);
+			sizes[slot] += size;
+		}
+	}
+	for (unsigned int slot = 0; slot < replicas.size(); ++slot) {
+		local |= sendRequest(trans, replicas[slot], batches[slot]);
+	}
+	if (local) {
+		checkStatus(trans);
+	}
+	flushOutbox();
+}
+
+/**
+ * FUNCTION NAME: batchCapacity
+ *
+ * DESCRIPTION: Bytes of sub-operations a BATCH or BATCHREPLY holds so that it fits in a network message
+ */
+int MP2Node::batchCapacity() {
+	return par->MAX_MSG_SIZE - (int)sizeof(en_msg) - BATCH_OP_OVERHEAD;
 }
 
 /**
@@ -194,15 +431,9 @@ void MP2Node::clientDelete(string key){
  * 			   	1) Inserts key value into the local hash table
  * 			   	2) Return true or false based on success or failure
  */
-bool MP2Node::createKeyValue(string key, string value, ReplicaType replica) {
+bool MP2Node::createKeyValue(const string &key, const string &value, ReplicaType replica, const Version &version) {
 	// Insert key, value, replicaType into the hash table
-	if (ht->count(key)) {
-		return false;
-	} else {
-		Entry entry(value, memberNode->heartbeat, replica);
-		ht->create(key, entry.convertToString());
-		return true;
-	}
+	return ht->create(key, Entry(value, memberNode->heartbeat, replica, version));
 }
 
 /**
@@ -213,13 +444,16 @@ bool MP2Node::createKeyValue(string key, string value, ReplicaType replica) {
  * 			    1) Read key from local hash table
  * 			    2) Return value
  */
-string MP2Node::readKey(string key) {
+string MP2Node::readKey(const string &key, Version *version) {
 	// Read key from local hash table and return value
-	if (!ht->count(key)) {
+	Entry *entry = ht->read(key);
+	if (!entry) {
 		return "";
 	}
-	Entry entry(ht->read(key));
-	return entry.value;
+	if (version) {
+		*version = entry->version;
+	}
+	return entry->value;
 }
 
 /**
@@ -229,21 +463,23 @@ string MP2Node::readKey(string key) {
  * 				This function does the following:
  * 				1) Update the key to the new value in the local hash table
  * 				2) Return true or false based on success or failure
+ * 				A value older than the stored one is acknowledged but not applied (last writer wins)
  */
-bool MP2Node::updateKeyValue(string key, string value, ReplicaType replica) {
-	// Update key in local hash table and return true or false
-	if (ht->read(key).empty()) {
+bool MP2Node::updateKeyValue(const string &key, const string &value, ReplicaType replica, const Version &version) {
+	// Update key in local hash table (in place) and return true or false
+	Entry *entry = ht->read(key);
+	if (!entry) {
 		return false;
-	} else {
-		Entry entry(ht->read(key));
-		entry.value = value;
-		entry.timestamp = memberNode->heartbeat;
-		if (replica != RESERVED) {
-			entry.replica = replica;
-		}
-		ht->update(key, entry.convertToString());
-		return true;
 	}
+	if (!(version < entry->version)) {
+		entry->value = value;
+		entry->version = version;
+	}
+	entry->timestamp = memberNode->heartbeat;
+	if (replica != RESERVED) {
+		entry->replica = replica;
+	}
+	return true;
 }
 
 /**
@@ -254,16 +490,158 @@ bool MP2Node::updateKeyValue(string key, string value, ReplicaType replica) {
  * 				1) Delete the key from the local hash table
  * 				2) Return true or false based on success or failure
  */
-bool MP2Node::deleteKey(string key) {
+bool MP2Node::deleteKey(const string &key) {
 	// Delete the key from the local hash table
-	if (ht->read(key).empty()) {
-		return false;
-	} else {
-		ht->deleteKey(key);
-		return true;
+	return ht->deleteKey(key);
+}
+
+/**
+ * FUNCTION NAME: serveRequest
+ *
+ * DESCRIPTION: Server side of a CREATE, READ, UPDATE or DELETE, from the network or from this
+ * 				node coordinating it (see sendRequest)
+ * 				This function does the following:
+ * 				1) Applies the request to the local hash table
+ * 				2) Logs the outcome
+ * 				3) Returns the reply for the coordinator
+ */
+Message MP2Node::serveRequest(const Message &rqst) {
+	bool status(false);
+	switch (rqst.type) {
+		case CREATE:
+			observe(rqst.version);
+			status = createKeyValue(rqst.key, rqst.value, rqst.replica, rqst.version);
+			if (status) {
+				log->logCreateSuccess(&(memberNode->addr), false, rqst.transID, rqst.key, rqst.value);
+			} else {
+				log->logCreateFail(&(memberNode->addr), false, rqst.transID, rqst.key, rqst.value);
+			}
+			break;
+		case READ: {
+			Version version = Version();
+			string result = readKey(rqst.key, &version);
+			if (result.size()) {
+				log->logReadSuccess(&(memberNode->addr), false, rqst.transID, rqst.key, result);
+			} else {
+				log->logReadFail(&(memberNode->addr), false, rqst.transID, rqst.key);
+			}
+			Message reply(rqst.transID, memberNode->addr, rqst.digestOnly ? "" : result);
+			reply.version = version;
+			if (rqst.digestOnly) {
+				reply.digestOnly = true;
+				reply.digest = valueDigest(result.data(), result.size());
+			}
+			return reply;
+		}
+		case UPDATE:
+			observe(rqst.version);
+			status = updateKeyValue(rqst.key, rqst.value, rqst.replica, rqst.version);
+			if (status) {
+				log->logUpdateSuccess(&(memberNode->addr), false, rqst.transID, rqst.key, rqst.value);
+			} else {
+				log->logUpdateFail(&(memberNode->addr), false, rqst.transID, rqst.key, rqst.value);
+			}
+			break;
+		case DELETE:
+			status = deleteKey(rqst.key);
+			if (status) {
+				log->logDeleteSuccess(&memberNode->addr, false, rqst.transID, rqst.key);
+			} else {
+				log->logDeleteFail(&memberNode->addr, false, rqst.transID, rqst.key);
+			}
+			break;
+		default:
+			break;
+	}
+	return Message(rqst.transID, memberNode->addr, REPLY, status);
+}
+
+/**
+ * FUNCTION NAME: serveBatch
+ *
+ * DESCRIPTION: Server side of a BATCH: serve every sub-operation as its single-key request
+ * 				and collect the results, in more than one BATCHREPLY if they do not fit in one
+ */
+void MP2Node::serveBatch(const Message &rqst, vector<Message> &replies) {
+	int capacity = batchCapacity();
+	int size(0);
+	replies.push_back(Message(rqst.transID, memberNode->addr, BATCHREPLY));
+	for (const BatchOp &op : rqst.ops) {
+		Message single(rqst.transID, memberNode->addr, op.type, op.key, op.value, op.replica);
+		single.version = op.version;
+		Message reply = serveRequest(single);
+		// a read succeeds on a replica holding the key
+		bool success = (op.type == READ) ? !reply.value.empty() : reply.success;
+		int opSize = reply.value.size() + BATCH_OP_OVERHEAD;
+		if (replies.back().ops.size() && size + opSize > capacity) {
+			replies.push_back(Message(rqst.transID, memberNode->addr, BATCHREPLY));
+			size = 0;
+		}
+		replies.back().addOp(op.type, RESERVED, op.index, success, "", reply.value, reply.version);
+		size += opSize;
+	}
+}
+
+/**
+ * FUNCTION NAME: handleMessage
+ *
+ * DESCRIPTION: Handle one message according to its type
+ * 				Key and value are parsed in place from the buffer
+ * 				Also ensure all CRUD operation get QUORUM replies
+ */
+void MP2Node::handleMessage(const char *data, int size) {
+	MessageView msg(data, size);
+	// drop a corrupt or truncated message
+	if (!msg.valid) {
+		return;
+	}
+	switch (msg.type) {
+		case CREATE:
+		case READ:
+		case UPDATE:
+		case DELETE:
+			dispatchMessages(&(msg.fromAddr), serveRequest(Message(msg)));
+			break;
+		case BATCH: {
+			vector<Message> replies;
+			serveBatch(Message(msg), replies);
+			for (Message &reply : replies) {
+				dispatchMessages(&(msg.fromAddr), reply);
+			}
+			break;
+		}
+		case BATCHREPLY: {
+			Transaction *trans = transactions.find(msg.transID);
+			if (trans) {
+				rtts.sample(&(msg.fromAddr), BATCH, memberNode->heartbeat - trans->issued);
+				for (BatchOpView &op : msg.ops) {
+					observe(op.version);
+				}
+				trans->addBatchReply(Message(msg));
+				checkStatus(trans);
+			}
+			break;
+		}
+		case REPLY:
+		case READREPLY: {
+			Transaction *trans = transactions.find(msg.transID);
+			if (trans) {
+				// the reply to a value fetch came after a second request, its round trip is unknown
+				if (!(trans->fetching && !msg.digestOnly && msg.fromAddr == trans->fetchFrom)) {
+					rtts.sample(&(msg.fromAddr), trans->type, memberNode->heartbeat - trans->sentTime(&(msg.fromAddr)));
+				}
+				observe(msg.version);
+				trans->addReply(msg);
+				checkStatus(trans);
+			}
+			break;
+		}
+		default:
+			break;
 	}
 }
 
+
 /**
  * FUNCTION NAME: checkMessages
  *
@@ -275,99 +653,245 @@ bool MP2Node::deleteKey(string key) {
 void MP2Node::checkMessages() {
 	char * data;
 	int size;
-	bool status;
 	// dequeue all messages and handle them
 	while (!memberNode->mp2q.empty()) {
 		// Pop a message from the queue
 		data = (char *)memberNode->mp2q.front().elt;
 		size = memberNode->mp2q.front().size;
 		memberNode->mp2q.pop();
-		string message(data, data + size);
-		// Handle the message types here
-		// Also ensure all CRUD operation get QUORUM replies
-		Message msg(message);
-		switch (msg.type) {
-			case CREATE: {
-				status = createKeyValue(msg.key, msg.value, msg.replica);
-				if (status) {
-					log->logCreateSuccess(&(memberNode->addr), false, msg.transID, msg.key, msg.value);
-					dispatchMessages(&(msg.fromAddr), Message(msg.transID, memberNode->addr, REPLY, true));
-				} else {
-					log->logCreateFail(&(memberNode->addr), false, msg.transID, msg.key, msg.value);
-					dispatchMessages(&(msg.fromAddr), Message(msg.transID, memberNode->addr, REPLY, false));
-				}
-				break;
-			}
-			case READ: {
-				string result = readKey(msg.key);
-				if (result.size()) {
-					log->logReadSuccess(&(memberNode->addr), false, msg.transID, msg.key, result);
-				} else {
-					log->logReadFail(&(memberNode->addr), false, msg.transID, msg.key);
-				}
-				dispatchMessages(&(msg.fromAddr), Message(msg.transID, memberNode->addr, result));
-				break;
-			}
-			case UPDATE: {
-				status = updateKeyValue(msg.key, msg.value, msg.replica);
-				if (status) {
-					log->logUpdateSuccess(&(memberNode->addr), false, msg.transID, msg.key, msg.value);
-					dispatchMessages(&(msg.fromAddr), Message(msg.transID, memberNode->addr, REPLY, true));
-				} else {
-					log->logUpdateFail(&(memberNode->addr), false, msg.transID, msg.key, msg.value);
-					dispatchMessages(&(msg.fromAddr), Message(msg.transID, memberNode->addr, REPLY, false));
-				}
-				break;
+		// An envelope carries the messages a node sent here during one pass, handle them in order
+		if (Envelope::isEnvelope(data, size)) {
+			const char *pos = data + 1;
+			const char *end = data + size;
+			while (pos < end) {
+				StringView frame = Envelope::nextFrame(pos, end);
+				handleMessage(frame.data, frame.size);
 			}
-			case DELETE: {
-				status = deleteKey(msg.key);
-				if (status) {
-					log->logDeleteSuccess(&memberNode->addr, false, msg.transID, msg.key);
-					dispatchMessages(&(msg.fromAddr), Message(msg.transID, memberNode->addr, REPLY, true));
-				} else {
-					log->logDeleteFail(&memberNode->addr, false, msg.transID, msg.key);
-					dispatchMessages(&(msg.fromAddr), Message(msg.transID, memberNode->addr, REPLY, false));
+		} else {
+			handleMessage(data, size);
+		}
+		// The buffer was handed over by EmulNet, give it back
+		emulNet->ENfree(data);
+	}
+	// Fire the transaction deadlines that passed, skipping transactions that completed in time
+	vector<TimerEntry> expired;
+	timers.advance(memberNode->heartbeat, expired);
+	vector<Transaction *> timeouts;
+	for (TimerEntry &timer : expired) {
+		Transaction *trans = transactions.find(timer.id);
+		if (!trans) {
+			continue;
+		}
+		if (trans->deadline == timer.deadline) {
+			// the quorum replied but the replica holding the value is silent, ask the newest one for it
+			if (trans->type == READ && trans->state == TRANS_PENDING && !trans->fetching && trans->received >= trans->quorum) {
+				int newest = newestReply(trans);
+				if (newest >= 0) {
+					fetchValue(trans, newest);
+					continue;
 				}
-				break;
 			}
-			case REPLY:
-			case READREPLY:
-				if (timeoutBook.count(msg.transID)) {
-					replyBook[msg.transID].push_back(msg.toString());
-					checkStatus(msg.transID);
-				}
-				break;
+			timeouts.push_back(trans);
+		} else if (trans->hedgeAt == timer.deadline && trans->state == TRANS_PENDING) {
+			// the replicas asked first are late, ask the next one
+			hedgeRead(trans);
 		}
 	}
-	// Go over transaction book to report timeout transactions
-	vector<int> timeouts;
-	for (pair<int, vector<long>> trans : timeoutBook) {
-		if (trans.second[0] + TIMEOUT <= memberNode->heartbeat) {
-			Message rqst(replyBook[trans.first][0]);
-			switch (rqst.type) {
+	for (Transaction *trans : timeouts) {
+		// the keys of a batch still waiting for replies fail, checkBatch closes it
+		if (trans->type == BATCH) {
+			checkBatch(trans, true);
+			continue;
+		}
+		// a read that already reported success was only waiting to repair stale replicas
+		if (trans->state == TRANS_PENDING) {
+			switch (trans->type) {
 				case CREATE:
-					log->logCreateFail(&(memberNode->addr), true, rqst.transID, rqst.key, rqst.value);
+					log->logCreateFail(&(memberNode->addr), true, trans->transID, trans->key, trans->value);
 					break;
 				case READ:
 					cout << "fail for timeout" << endl;
-					log->logReadFail(&(memberNode->addr), true, rqst.transID, rqst.key);
+					log->logReadFail(&(memberNode->addr), true, trans->transID, trans->key);
 					break;
 				case UPDATE:
-					log->logUpdateFail(&(memberNode->addr), true, rqst.transID, rqst.key, rqst.value);
+					log->logUpdateFail(&(memberNode->addr), true, trans->transID, trans->key, trans->value);
 					break;
 				case DELETE:
-					log->logDeleteFail(&(memberNode->addr), true, rqst.transID, rqst.key);
+					log->logDeleteFail(&(memberNode->addr), true, trans->transID, trans->key);
 					break;
 				default:
 					break;
 			}
-			timeouts.push_back(trans.first);
+		}
+		closeTransaction(trans);
+	}
+	flushOutbox();
+}
+
+/**
+ * FUNCTION NAME: openTransaction
+ *
+ * DESCRIPTION: Register transaction g_transID sent to the replicas and arm its timer
+ * 				The transaction fails once the quorum-th fastest replica is late by its RTO,
+ * 				a read that succeeded waits for the slowest one to repair it
+ */
+Transaction *MP2Node::openTransaction(MessageType type, const string &key, const string &value, const vector<Address *> &replicas, int quorum) {
+	long deadline = memberNode->heartbeat + rtts.quorumTimeout(replicas, type, quorum);
+	Transaction *trans = transactions.open(g_transID, type, key, value, memberNode->heartbeat, deadline, replicas.size(), quorum);
+	trans->repairDeadline = memberNode->heartbeat + rtts.quorumTimeout(replicas, type, replicas.size());
+	timers.schedule(g_transID, deadline);
+	return trans;
+}
+
+/**
+ * FUNCTION NAME: closeTransaction
+ *
+ * DESCRIPTION: Account a finished transaction and give its record back
+ */
+void MP2Node::closeTransaction(Transaction *trans) {
+	if (trans->hedgeWon) {
+		// without the hedge the read would have waited for the replies that came after it completed
+		++readStats.hedgeWins;
+		readStats.savedTicks += memberNode->heartbeat - trans->completed;
+	}
+	transactions.close(trans);
+}
+
+/**
+ * FUNCTION NAME: hedgeRead
+ *
+ * DESCRIPTION: Send a speculative read to the next spare replica
+ *
+ * RETURNS:
+ * false if every replica was asked already
+ */
+bool MP2Node::hedgeRead(Transaction *trans) {
+	if (trans->nextSpare >= (int)trans->spares.size()) {
+		return false;
+	}
+	TransSpare &spare = trans->spares[trans->nextSpare++];
+	spare.sentAt = memberNode->heartbeat;
+	++trans->expected;
+	++readStats.hedges;
+	// give the hedge its own timeout, and hedge again if it is late as well
+	long deadline = memberNode->heartbeat + rtts.rto(&(spare.addr), READ);
+	trans->repairDeadline = max(trans->repairDeadline, deadline);
+	if (deadline > trans->deadline) {
+		trans->deadline = deadline;
+		timers.schedule(trans->transID, deadline);
+	}
+	armHedge(trans, rtts.percentile(&(spare.addr), READ, par->HEDGE_PERCENTILE));
+	// a reply of this node may complete the read, trans must not be used after it
+	if (sendRequest(trans, &(spare.addr), Message(trans->transID, memberNode->addr, READ, trans->key))) {
+		checkStatus(trans);
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: newestReply
+ *
+ * DESCRIPTION: Reply of a read carrying the newest version, replicas missing the key
+ * 				(MSG_DIGEST_NONE) never count
+ *
+ * RETURNS:
+ * index in trans->replies, -1 if no replica had the key
+ */
+int MP2Node::newestReply(Transaction *trans) {
+	int newest(-1);
+	for (int i = 0; i < trans->received; ++i) {
+		TransReply &reply = trans->replies[i];
+		if (reply.digest == MSG_DIGEST_NONE) {
+			continue;
+		}
+		if (newest < 0 || trans->replies[newest].version < reply.version) {
+			newest = i;
+		}
+	}
+	return newest;
+}
+
+/**
+ * FUNCTION NAME: fetchValue
+ *
+ * DESCRIPTION: Ask the replica of a digest reply for its value
+ */
+void MP2Node::fetchValue(Transaction *trans, int index) {
+	Address from = trans->replies[index].from;
+	trans->fetching = true;
+	trans->fetchFrom = from;
+	++trans->expected;
+	long deadline = memberNode->heartbeat + rtts.rto(&from, READ);
+	trans->repairDeadline = max(trans->repairDeadline, deadline);
+	if (deadline > trans->deadline) {
+		trans->deadline = deadline;
+		timers.schedule(trans->transID, deadline);
+	}
+	// a reply of this node may complete the read, trans must not be used after it
+	if (sendRequest(trans, &from, Message(trans->transID, memberNode->addr, READ, trans->key))) {
+		checkStatus(trans);
+	}
+}
+
+/**
+ * FUNCTION NAME: nextVersion
+ *
+ * DESCRIPTION: Stamp a write: the simulated wall time, or one logical step past the newest
+ * 				version seen when the clock has not moved since
+ */
+Version MP2Node::nextVersion() {
+	long now = par->getcurrtime();
+	if (now > clock.wall) {
+		clock.wall = now;
+		clock.logical = 0;
+	} else {
+		++clock.logical;
+	}
+	clock.node = *(int *)(&memberNode->addr.addr);
+	return clock;
+}
+
+/**
+ * FUNCTION NAME: observe
+ *
+ * DESCRIPTION: Move the clock past a version received from another node
+ */
+void MP2Node::observe(const Version &version) {
+	if (clock < version) {
+		clock = version;
+	}
+}
+
+/**
+ * FUNCTION NAME: armHedge
+ *
+ * DESCRIPTION: Hedge to the next spare replica wait ticks from now, at the latest a tick before the read fails
+ */
+void MP2Node::armHedge(Transaction *trans, long wait) {
+	trans->hedgeAt = -1;
+	if (trans->nextSpare < (int)trans->spares.size()) {
+		// replicas without samples wait their whole RTO, hedge the tick before the read would fail
+		trans->hedgeAt = max(memberNode->heartbeat + 1, min(memberNode->heartbeat + wait, trans->deadline - 1));
+		if (trans->hedgeAt < trans->deadline) {
+			timers.schedule(trans->transID, trans->hedgeAt);
+		} else {
+			trans->hedgeAt = -1;
 		}
 	}
-	for (int timeout : timeouts) {
-		timeoutBook.erase(timeout);
-		replyBook.erase(timeout);
+}
+
+/**
+ * FUNCTION NAME: writeReadStats
+ *
+ * DESCRIPTION: Print the read and hedge counters of this coordinator
+ */
+void MP2Node::writeReadStats(FILE *file) {
+	fprintf(file, "coordinator %s reads %ld hedges %ld hedge_wins %ld saved_ticks %ld latency",
+			memberNode->addr.getAddress().c_str(), readStats.reads, readStats.hedges, readStats.hedgeWins, readStats.savedTicks);
+	for (int i = 0; i < RTT_BUCKETS; ++i) {
+		fprintf(file, " %ld", readStats.latency[i]);
 	}
+	fprintf(file, "\n");
 }
 
 /**
@@ -378,129 +902,190 @@ void MP2Node::checkMessages() {
  *				2) Client Transition expects Quorum response
  *				3) Read Transition has read repair
  */
-void MP2Node::checkStatus(int transID) {
-	int count = timeoutBook[transID][1];
-	int size = replyBook[transID].size();
-	// Not receive quorum reply yet
-	if (size - 1 < ((count + 1) / 2)) {
+void MP2Node::checkStatus(Transaction *trans) {
+	if (trans->type == BATCH) {
+		checkBatch(trans, false);
 		return;
 	}
-	Message rqst(replyBook[transID][0]);
-	vector<Message> msgs;
-	if (rqst.type == READ) {
-		// Read always expect 3 replies as maximum
-		msgs.push_back(Message(replyBook[transID][1]));
-		msgs.push_back(Message(replyBook[transID][2]));
-		// Only 2 replies received
-		if (size == count) {
-			if (msgs[0].value == "" && msgs[1].value == "") {
-				// Quorum failure received, log failure and remove entry
-				cout << "fail for 2 failures" << endl;
-				log->logReadFail(&(memberNode->addr), true, transID, rqst.key);
-				replyBook.erase(transID);
-				timeoutBook.erase(transID);
-			} else if (msgs[0].value == msgs[1].value && msgs[0].value != "") {
-				cout << "success for 2 consistent success" << endl;
-				// Quorum success received, and they are consistent. log succ and wait for 3rd reply to repair read
-				log->logReadSuccess(&(memberNode->addr), true, transID, rqst.key, msgs[0].value);
-				timeoutBook[transID][2] = 1;
-			} else {
-				// Neeed the 3rd reply to make the decision, do nothing
+	int quorum = trans->quorum;
+	// Not receive quorum reply yet, a speculative read looks at every reply to hedge early
+	if (trans->received < quorum && trans->spares.empty()) {
+		return;
+	}
+	int remaining = trans->remaining();
+	if (trans->type == READ) {
+		// The newest version among the replies wins, a replica missing the key has none
+		int newest = newestReply(trans);
+		// Value of the newest version, digest replies carry none
+		string value("");
+		Version version = Version();
+		bool found(false), full(false);
+		if (newest >= 0) {
+			version = trans->replies[newest].version;
+			for (int i = 0; i < trans->received && !found; ++i) {
+				TransReply &reply = trans->replies[i];
+				if (reply.full) {
+					full = true;
+					if (reply.version == version && reply.digest == trans->replies[newest].digest) {
+						value = reply.value;
+						found = true;
+					}
+				}
 			}
-		} else {
-			msgs.push_back(Message(replyBook[transID][3]));
-			int blank(0);
-			map<string ,int> candidates;
-			for (Message &msg : msgs) {
-				if (msg.value == "") {
-					++blank;
-				} else {
-					++candidates[msg.value];
+		}
+		if (trans->received >= quorum && newest >= 0) {
+			if (!found) {
+				// The replica asked for the value is stale, fetch the value from the newest one.
+				// Until it replied the value may still come, a timeout fetches it then (see checkMessages)
+				if (full && !trans->fetching) {
+					fetchValue(trans, newest);
 				}
+				return;
 			}
-			if (blank > 1) {
-				// Quorum failure received, log failure and remove entry
-				cout << "fail for quorum failures" << endl;
-				log->logReadFail(&(memberNode->addr), true, transID, rqst.key);
-			} else if (blank + candidates.size() == 3) {
-				// Quorum success received but not consistent
-				cout << "fail for inconsistent success" << endl;
-				log->logReadFail(&(memberNode->addr), true, transID, rqst.key);
-			} else {
-				// Quorum success received and consistent
-				cout << "success for quorum consistent success" << endl;
-				string value("");
-				for (pair<string, int> candidate : candidates) {
-					if (candidate.second == 1) {
-						continue;
-					}
-					value = candidate.first;
+			// Quorum replied, log the newest value once
+			if (trans->state == TRANS_PENDING) {
+				log->logReadSuccess(&(memberNode->addr), true, trans->transID, trans->key, value);
+				trans->state = TRANS_REPORTED;
+				trans->completed = memberNode->heartbeat;
+				trans->hedgeWon = trans->repliedByHedge();
+				++readStats.latency[min(memberNode->heartbeat - trans->issued, (long)RTT_BUCKETS - 1)];
+				// the old timer is ignored once the deadline moved
+				if (remaining > 0 && trans->repairDeadline > trans->deadline) {
+					trans->deadline = trans->repairDeadline;
+					timers.schedule(trans->transID, trans->deadline);
+				}
+			}
+			// Wait for every reply to repair the stale replicas
+			if (remaining > 0) {
+				return;
+			}
+			for (int i = 0; i < trans->received; ++i) {
+				TransReply &reply = trans->replies[i];
+				if (reply.digest != MSG_DIGEST_NONE && !(reply.version < version)) {
+					continue;
 				}
-				// The case 3rd reply is required for the log success
-				if (timeoutBook[transID][2] == 0) {
-					log->logReadSuccess(&(memberNode->addr), true, transID, rqst.key, value);
-					timeoutBook[transID][2] = 1;
+				Transaction *repairTrans = openTransaction(UPDATE, trans->key, value, vector<Address *>(1, &(reply.from)), 1);
+				++g_transID;
+				Message repair(repairTrans->transID, memberNode->addr, UPDATE, trans->key, value, RESERVED);
+				repair.version = version;
+				if (sendRequest(repairTrans, &(reply.from), repair)) {
+					checkStatus(repairTrans);
 				}
-				// Read repair message
-				for (Message &msg : msgs) {
-					if (msg.value == value) {
-						continue;
-					}
-					Message repair(g_transID, memberNode->addr, UPDATE, rqst.key, value, RESERVED);
-					dispatchMessages(&(msg.fromAddr), repair);
-					timeoutBook[g_transID] = vector<long>({memberNode->heartbeat, 1, 0});
-					replyBook[g_transID].push_back(repair.toString());
-					++g_transID;
-				}	
 			}
-			replyBook.erase(transID);
-			timeoutBook.erase(transID);
+		} else if (trans->received >= quorum || trans->received + remaining < quorum) {
+			// A speculative read still has replicas to ask before giving up
+			if (trans->state == TRANS_PENDING && hedgeRead(trans)) {
+				return;
+			}
+			// No replica of the quorum has the key, or too many failed to form a quorum
+			cout << "fail for quorum failures" << endl;
+			log->logReadFail(&(memberNode->addr), true, trans->transID, trans->key);
+		} else {
+			// Neeed more replies to make the decision, do nothing
+			return;
 		}
 	} else {
 		// Handle CREATE, UPDATE and DELETE requests
-		int fail(0), succ(0);
-		for (int i = 1; i < size; ++i) {
-			msgs.push_back(Message(replyBook[transID][i]));
-		}
-		for (Message &msg : msgs) {
-			if (msg.success) {
+		int succ(0);
+		for (int i = 0; i < trans->received; ++i) {
+			if (trans->replies[i].success) {
 				++succ;
-			} else {
-				++fail;
 			}
 		}
 		// Not receive enough reply to make the decision
-		if (succ < ((count + 1)) / 2 && fail < ((count + 1) / 2)) {
+		if (succ < quorum && succ + remaining >= quorum) {
 			return;
 		}
 		// Log success and fail based on quorum
-		switch (rqst.type) {
+		switch (trans->type) {
 			case CREATE: 
-				if (succ >= ((count + 1) / 2)) {
-					log->logCreateSuccess(&(memberNode->addr), true, transID, rqst.key, rqst.value);
+				if (succ >= quorum) {
+					log->logCreateSuccess(&(memberNode->addr), true, trans->transID, trans->key, trans->value);
+				} else {
+					log->logCreateFail(&(memberNode->addr), true, trans->transID, trans->key, trans->value);
+				}
+				break;
+			case UPDATE:
+				if (succ >= quorum) {
+					log->logUpdateSuccess(&(memberNode->addr), true, trans->transID, trans->key, trans->value);
 				} else {
-					log->logCreateFail(&(memberNode->addr), true, transID, rqst.key, rqst.value);
+					log->logUpdateFail(&(memberNode->addr), true, trans->transID, trans->key, trans->value);
+				}
+				break;
+			case DELETE:
+				if (succ >= quorum) {
+					log->logDeleteSuccess(&(memberNode->addr), true, trans->transID, trans->key);
+				} else {
+					log->logDeleteFail(&(memberNode->addr), true, trans->transID, trans->key);
+				}
+				break;
+			default:
+				break;
+		}
+	}
+	closeTransaction(trans);
+}
+
+/**
+ * FUNCTION NAME: checkBatch
+ *
+ * DESCRIPTION: Log the outcome of every key of a batch transaction that reached its quorum,
+ * 				or can no longer reach it, and close the batch once every key is logged.
+ * 				On timeout every key still waiting fails
+ */
+void MP2Node::checkBatch(Transaction *trans, bool timeout) {
+	int quorum = trans->quorum;
+	for (BatchKey &entry : trans->keys) {
+		if (entry.reported) {
+			continue;
+		}
+		bool success = entry.succeeded >= quorum;
+		// a read needs quorum replies, any of them holding the key gives the newest value
+		if (entry.type == READ) {
+			success = entry.received >= quorum && entry.succeeded > 0;
+			if (!success && !timeout && entry.received < quorum) {
+				continue;
+			}
+		} else if (!success && !timeout && entry.succeeded + entry.expected - entry.received >= quorum) {
+			continue;
+		}
+		switch (entry.type) {
+			case CREATE:
+				if (success) {
+					log->logCreateSuccess(&(memberNode->addr), true, trans->transID, entry.key, entry.value);
+				} else {
+					log->logCreateFail(&(memberNode->addr), true, trans->transID, entry.key, entry.value);
+				}
+				break;
+			case READ:
+				if (success) {
+					log->logReadSuccess(&(memberNode->addr), true, trans->transID, entry.key, entry.value);
+				} else {
+					log->logReadFail(&(memberNode->addr), true, trans->transID, entry.key);
 				}
 				break;
 			case UPDATE:
-				if (succ >= (count + 1) / 2) {
-					log->logUpdateSuccess(&(memberNode->addr), true, transID, rqst.key, rqst.value);
+				if (success) {
+					log->logUpdateSuccess(&(memberNode->addr), true, trans->transID, entry.key, entry.value);
 				} else {
-					log->logUpdateFail(&(memberNode->addr), true, transID, rqst.key, rqst.value);
+					log->logUpdateFail(&(memberNode->addr), true, trans->transID, entry.key, entry.value);
 				}
 				break;
 			case DELETE:
-				if (succ >= (count + 1) / 2) {
-					log->logDeleteSuccess(&(memberNode->addr), true, transID, rqst.key);
+				if (success) {
+					log->logDeleteSuccess(&(memberNode->addr), true, trans->transID, entry.key);
 				} else {
-					log->logDeleteFail(&(memberNode->addr), true, transID, rqst.key);
+					log->logDeleteFail(&(memberNode->addr), true, trans->transID, entry.key);
 				}
 				break;
 			default:
 				break;
 		}
-		timeoutBook.erase(transID);
-		replyBook.erase(transID);
+		entry.reported = true;
+		--trans->unreported;
+	}
+	if (trans->unreported == 0) {
+		closeTransaction(trans);
 	}
 }
 
@@ -509,29 +1094,15 @@ void MP2Node::checkStatus(int transID) {
  *
  * DESCRIPTION: Find the replicas of the given keyfunction
  * 				This function is responsible for finding the replicas of a key
+ * 				It copies the nodes out for the application, the CRUD paths read
+ * 				ring->preferenceList() directly
  */
 vector<Node> MP2Node::findNodes(string key) {
-	size_t pos = hashFunction(key);
 	vector<Node> addr_vec;
-	int size = ring.size();
-	if (size >= 3) {
-		// if pos <= min || pos > max, the leader is the min
-		if (pos <= ring.at(0).getHashCode() || pos > ring.at(size-1).getHashCode()) {
-			addr_vec.emplace_back(ring.at(0));
-			addr_vec.emplace_back(ring.at(1));
-			addr_vec.emplace_back(ring.at(2));
-		}
-		else {
-			// go through the ring until pos <= node
-			for (int i=1; i < size; i++){
-				Node addr = ring.at(i);
-				if (pos <= addr.getHashCode()) {
-					addr_vec.emplace_back(addr);
-					addr_vec.emplace_back(ring.at((i+1)%size));
-					addr_vec.emplace_back(ring.at((i+2)%size));
-					break;
-				}
-			}
+	const int *replicas = ring->preferenceList(hashFunction(key));
+	if (replicas) {
+		for (int i = 0; i < par->RF; ++i) {
+			addr_vec.emplace_back(ring->member(replicas[i]));
 		}
 	}
 	return addr_vec;
@@ -571,122 +1142,135 @@ int MP2Node::enqueueWrapper(void *env, char *buff, int size) {
  *				Note:- "CORRECT" replicas implies that every key is replicated in its two neighboring nodes in the ring
  */
 void MP2Node::stabilizationProtocol() {
-	/*
-	 * Implement this
-	 */
-	// TODO: Go over entire hashtable, check key-value one be one
-	// 1. use hasMyReplica and hasReplicaOf to figure out who store the key-value previously
-	// 2. use findNodes method to figure out who should store the key-value currently
-	// 3. if something changes, the highest non-faulty node should send CREATE message to node doesn't has the key-value
-	// 	primary > sencondary > tertiary, expect Quorum success response, otherwise report a failure
-	// 4. also update the replica type in itself
-	// 5. update hasMyReplica and hasReplicaOf at the end
-	int size = ring.size();	
-	vector<Node> masters, slaves;
-	set<size_t> nodeBook;
+	// For every local key, compare its replica set before and after the membership change.
+	// The first replica of the old set that is still alive copies the key to the replicas
+	// that joined the set, so exactly one node hands each key over. Every holder then
+	// updates its own replica type and drops the keys it is no longer a replica of.
 	Node myself(memberNode->addr);
-	for (int i = 0; i < size; ++i) {
-		nodeBook.insert(ring[i].nodeHashCode);
-		if (ring[i] == myself) {
-			int start = (i - 2 + size) % size;
-			masters.emplace_back(ring[start]);
-			masters.emplace_back(ring[(start + 1) % size]);
-			slaves.emplace_back(ring[(i + 1) % size]);
-			slaves.emplace_back(ring[(i + 2) % size]);
-		}
-	}
-	// cluster doesn't change, safe to return
-	if (haveReplicasOf == masters && hasMyReplicas == slaves) {
-		return;
-	}
-	// cluster changes (node join, leave or fail)
 	vector<string> overReplicas;
-	if (size >= 3) {
-		for (map<string, string>::iterator iter = ht->hashTable.begin(); iter != ht->hashTable.end(); ++iter) {
-			string key = iter->first;
-			Entry entry(iter->second);
-			string value = entry.value;
-			ReplicaType replica = entry.replica;
-			vector<Node> expects = findNodes(key);
-			int count(0);
-			if (replica == PRIMARY) {
-				if (expects[0] != myself && expects[0] != hasMyReplicas[0] && expects[0] != hasMyReplicas[1]) {
-					dispatchMessages(&(expects[0].nodeAddress), Message(g_transID, myself.nodeAddress, CREATE, key, value, PRIMARY));
-					++count;
-				}
-				if (expects[1] != myself && expects[1] != hasMyReplicas[0] && expects[1] != hasMyReplicas[1]) {
-					dispatchMessages(&(expects[1].nodeAddress), Message(g_transID, myself.nodeAddress, CREATE, key, value, SECONDARY));
-					++count;
-				}
-				if (expects[2] != myself && expects[2] != hasMyReplicas[0] && expects[2] != hasMyReplicas[1]) {
-					dispatchMessages(&(expects[2].nodeAddress), Message(g_transID, myself.nodeAddress, CREATE, key, value, TERTIARY));
-					++count;
-				}
-			} else if (replica == SECONDARY) {
-				// The primary replica is still alive, let it handle the stability
-				if (nodeBook.count(haveReplicasOf[1].nodeHashCode)) {
-					continue;
-				}
-				if (expects[0] != haveReplicasOf[1] && expects[0] != myself && expects[0] != hasMyReplicas[0]) {
-					dispatchMessages(&(expects[0].nodeAddress), Message(g_transID, myself.nodeAddress, CREATE, key, value, PRIMARY));
-					++count;
-				}
-				if (expects[1] != haveReplicasOf[1] && expects[1] != myself && expects[1] != hasMyReplicas[0]) {
-					dispatchMessages(&(expects[1].nodeAddress), Message(g_transID, myself.nodeAddress, CREATE, key, value, SECONDARY));
-					++count;
-				}
-				if (expects[2] != haveReplicasOf[1] && expects[2] != myself && expects[2] != hasMyReplicas[0]) {
-					dispatchMessages(&(expects[2].nodeAddress), Message(g_transID, myself.nodeAddress, CREATE, key, value, TERTIARY));
-					++count;
-				}
-			} else {
-				// THe primary replica or the secondary replica is alive, let them to handle the stability
-				if (nodeBook.count(haveReplicasOf[0].nodeHashCode || nodeBook.count(haveReplicasOf[1].nodeHashCode))) {
-					continue;
-				}
-				if (expects[0] != haveReplicasOf[0] && expects[0] != haveReplicasOf[1] && expects[0] != myself) {
-					dispatchMessages(&(expects[0].nodeAddress), Message(g_transID, myself.nodeAddress, CREATE, key, value, PRIMARY));
-					++count;
-				}
-				if (expects[1] != haveReplicasOf[0] && expects[1] != haveReplicasOf[1] && expects[1] != myself) {
-					dispatchMessages(&(expects[1].nodeAddress), Message(g_transID, myself.nodeAddress, CREATE, key, value, SECONDARY));
-					++count;
-				}
-				if (expects[2] != haveReplicasOf[0] && expects[2] != haveReplicasOf[1] && expects[2] != myself) {
-					dispatchMessages(&(expects[2].nodeAddress), Message(g_transID, myself.nodeAddress, CREATE, key, value, TERTIARY));
-					++count;
+	for (HashTableStore::iterator iter = ht->hashTable.begin(); iter != ht->hashTable.end(); ++iter) {
+		const string &key = iter->first;
+		Entry &entry = iter->second;
+		uint64_t hash = hashFunction(key);
+		const int *expects = ring->preferenceList(hash);
+		// not enough nodes for a full replica set, keep what we have
+		if (!expects) {
+			continue;
+		}
+		const int *previous = prevRing->preferenceList(hash);
+		if (previous) {
+			int sender = -1;
+			for (int i = 0; i < par->RF && sender < 0; ++i) {
+				if (ring->find(prevRing->member(previous[i]).nodeAddress) >= 0) {
+					sender = previous[i];
 				}
-
 			}
-			if (count) {
-					timeoutBook[g_transID] = vector<long>({memberNode->heartbeat, count, 0});
-					replyBook[g_transID].push_back(Message(g_transID, myself.nodeAddress, CREATE, key, value, PRIMARY).toString());
+			if (sender >= 0 && prevRing->member(sender) == myself) {
+				vector<Address *> targets;
+				for (int i = 0; i < par->RF; ++i) {
+					Node &target = ring->member(expects[i]);
+					int old = prevRing->find(target.nodeAddress);
+					if (target == myself || (old >= 0 && find(previous, previous + par->RF, old) != previous + par->RF)) {
+						continue;
+					}
+					Message rqst(g_transID, myself.nodeAddress, CREATE, key, entry.value, static_cast<ReplicaType>(i));
+					rqst.version = entry.version;
+					dispatchMessages(&(target.nodeAddress), rqst);
+					targets.push_back(&(target.nodeAddress));
+				}
+				if (targets.size()) {
+					openTransaction(CREATE, key, entry.value, targets, (targets.size() + 1) / 2);
 					++g_transID;
+				}
 			}
-			// Update self replica type
-			if (expects[0] == myself) {
-				iter->second = Entry(value, memberNode->heartbeat, PRIMARY).convertToString();
-			} else if (expects[1] == myself) {
-				iter->second = Entry(value, memberNode->heartbeat, SECONDARY).convertToString();
-			} else if (expects[2] == myself) {
-				iter->second = Entry(value, memberNode->heartbeat, TERTIARY).convertToString();
-			} else {
-				overReplicas.push_back(key);
+		}
+		// Update self replica type
+		int position = -1;
+		for (int i = 0; i < par->RF; ++i) {
+			if (ring->member(expects[i]) == myself) {
+				position = i;
 			}
 		}
+		if (position >= 0) {
+			entry.timestamp = memberNode->heartbeat;
+			entry.replica = static_cast<ReplicaType>(position);
+		} else {
+			overReplicas.push_back(key);
+		}
 	}
 	for (string key : overReplicas) {
 		ht->deleteKey(key);
 	}
-	haveReplicasOf = masters;
-	hasMyReplicas = slaves;
+	flushOutbox();
+}
+
+/**
+ * FUNCTION NAME: sendRequest
+ *
+ * DESCRIPTION: Send a request of trans to a replica. A request to this node skips EmulNet:
+ * 				it is served right away and its reply recorded as a local vote
+ *
+ * RETURNS:
+ * true if a local vote was recorded, the caller runs checkStatus once it is done with trans
+ */
+bool MP2Node::sendRequest(Transaction *trans, Address *replica, const Message &rqst) {
+	if (!(*replica == memberNode->addr)) {
+		dispatchMessages(replica, rqst);
+		return false;
+	}
+	if (rqst.type == BATCH) {
+		vector<Message> replies;
+		serveBatch(rqst, replies);
+		for (Message &reply : replies) {
+			trans->addBatchReply(reply);
+		}
+	} else {
+		trans->addReply(serveRequest(rqst));
+	}
+	return true;
 }
 
 /*
  * FUNCTION NAME: dispatchMessages
  *
  * DESCRIPTION: dispatches messages to corresponding nodes
+ * 				Messages wait in the envelope of their destination until flushOutbox,
+ * 				an envelope that would not fit in a network message is sent first
  */
 void MP2Node::dispatchMessages(Address *destAddr, Message message) {
-	emulNet->ENsend(&memberNode->addr, destAddr, message.toString());
+	string encoded = message.encode();
+	Envelope &envelope = outbox[Member::memberKey(*(int *)(&destAddr->addr), *(short *)(&destAddr->addr[4]))];
+	if (envelope.count == 0) {
+		envelope.to = *destAddr;
+	} else if ((int)envelope.sizeWith(encoded) + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) {
+		sendEnvelope(envelope);
+		envelope.to = *destAddr;
+	}
+	envelope.add(encoded, message.type);
+}
+
+/**
+ * FUNCTION NAME: flushOutbox
+ *
+ * DESCRIPTION: Send the messages waiting in the outbox, one network message per destination
+ * 				Runs at the end of every checkMessages, client call and stabilization
+ */
+void MP2Node::flushOutbox() {
+	for (FlatHashMap<long long, Envelope>::iterator iter = outbox.begin(); iter != outbox.end(); ++iter) {
+		if (iter->second.count) {
+			sendEnvelope(iter->second);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: sendEnvelope
+ *
+ * DESCRIPTION: Send an envelope (its only message alone) and empty it
+ */
+void MP2Node::sendEnvelope(Envelope &envelope) {
+	StringView payload = envelope.payload();
+	int type = (envelope.count == 1) ? envelope.firstType : ENVELOPE;
+	emulNet->ENsend(&memberNode->addr, &envelope.to, payload.data, payload.size, type);
+	envelope.clear();
 }
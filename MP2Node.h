@@ -13,16 +13,35 @@
 #include "stdincludes.h"
 #include "EmulNet.h"
 #include "Node.h"
+#include "Placement.h"
 #include "HashTable.h"
 #include "Log.h"
 #include "Params.h"
 #include "Message.h"
 #include "Queue.h"
+#include "TransactionTable.h"
+#include "TimingWheel.h"
+#include "RttEstimator.h"
 
 /**
  * Macros
-*/
-#define TIMEOUT 10
+ */
+// Upper bound of the bytes a batch sub-operation takes besides its key and value (either codec),
+// the same room is kept for the batch header
+#define BATCH_OP_OVERHEAD 64
+
+/**
+ * STRUCT NAME: ReadStats
+ *
+ * DESCRIPTION: Counters of the reads a node coordinated
+ */
+struct ReadStats {
+	long reads;
+	long hedges;					// hedge requests sent
+	long hedgeWins;					// reads a hedge reply helped complete
+	long savedTicks;				// ticks from those completions to the last reply they would have waited for
+	long latency[RTT_BUCKETS];		// completion time of the successful reads
+};
 
 /**
  * CLASS NAME: MP2Node
@@ -36,18 +55,25 @@
  */
 class MP2Node {
 private:
-	// Vector holding the next two neighbors in the ring who have my replicas
-	vector<Node> hasMyReplicas;
-	// Vector holding the previous two neighbors in the ring whose replicas I have
-	vector<Node> haveReplicasOf;
-	// Ring
-	vector<Node> ring;
+	// Ring (or another placement strategy, see Params::PLACEMENT)
+	Placement *ring;
+	// Placement before the last membership change, tells who held each key
+	Placement *prevRing;
+	// memberVersion of the membership table the ring was built from
+	unsigned long ringVersion;
 	// Hash Table(main store)
 	HashTable * ht;
-	// Lookup table recording the local issue time, expected responses and log status of each transaction
-	map<int, vector<long>> timeoutBook;
-	// List holding the reply messages of transaction requested from this coordinate
-	map<int, vector<string>> replyBook;
+	// Transactions requested from this coordinate and the replies received so far
+	TransactionTable transactions;
+	// Deadlines of the transactions, a closed transaction leaves its timer behind
+	TimingWheel timers;
+	// Round-trip times of the replicas, the transaction deadlines are derived from them
+	RttEstimator rtts;
+	ReadStats readStats;
+	// Messages waiting to be sent, one envelope per destination keyed by memberKey
+	FlatHashMap<long long, Envelope> outbox;
+	// Hybrid logical clock, the newest version this node issued or saw
+	Version clock;
 	// Member representing this member
 	Member *memberNode;
 	// Params object
@@ -66,14 +92,20 @@ public:
 	// ring functionalities
 	void updateRing(); // TODO
 	vector<Node> getMembershipList();
-	size_t hashFunction(string key);
-	void findNeighbors(); // TODO
+	uint64_t hashFunction(const string &key);
 
 	// client side CRUD APIs
-	void clientCreate(string key, string value);
-	void clientRead(string key);
-	void clientUpdate(string key, string value);
-	void clientDelete(string key);
+	void clientCreate(string key, string value, ConsistencyLevel level = DEFAULT_LEVEL);
+	void clientRead(string key, ConsistencyLevel level = DEFAULT_LEVEL);
+	void clientUpdate(string key, string value, ConsistencyLevel level = DEFAULT_LEVEL);
+	void clientDelete(string key, ConsistencyLevel level = DEFAULT_LEVEL);
+	void logCoordinatorFail(MessageType type, int transID, const string &key, const string &value);
+
+	// client side batch APIs, one message per replica for all the keys it holds
+	void clientMultiGet(const vector<string> &keys, ConsistencyLevel level = DEFAULT_LEVEL);
+	void clientMultiPut(const map<string, string> &pairs, ConsistencyLevel level = DEFAULT_LEVEL);
+	void clientBatch(MessageType type, const vector<pair<string, string> > &pairs, ConsistencyLevel level);
+	int batchCapacity();
 
 	// receive messages from Emulnet
 	bool recvLoop();
@@ -81,21 +113,49 @@ public:
 
 	// handle messages from receiving queue
 	void checkMessages();
+	void handleMessage(const char *data, int size);
+
+	// register a transaction this node coordinates and arm its timeout
+	Transaction *openTransaction(MessageType type, const string &key, const string &value, const vector<Address *> &replicas, int quorum);
+	void closeTransaction(Transaction *trans);
+	RttEstimator & getRttEstimator() {
+		return rtts;
+	}
+	void writeReadStats(FILE *file);
+
+	// speculative reads
+	bool hedgeRead(Transaction *trans);
+	void armHedge(Transaction *trans, long wait);
+
+	// digest reads
+	int newestReply(Transaction *trans);
+	void fetchValue(Transaction *trans, int index);
 
 	// respond to client upon quorum response received
-	void checkStatus(int transID);
+	void checkStatus(Transaction *trans);
+	void checkBatch(Transaction *trans, bool timeout);
 
+	// coordinator sends a request to a replica, serving it locally when the replica is this node
+	bool sendRequest(Transaction *trans, Address *replica, const Message &rqst);
 	// coordinator dispatches messages to corresponding nodes
 	void dispatchMessages(Address *destAddr, Message message);
+	void flushOutbox();
+	void sendEnvelope(Envelope &envelope);
 
 	// find the addresses of nodes that are responsible for a key
 	vector<Node> findNodes(string key);
 
 	// server
-	bool createKeyValue(string key, string value, ReplicaType replica);
-	string readKey(string key);
-	bool updateKeyValue(string key, string value, ReplicaType replica);
-	bool deleteKey(string key);
+	Message serveRequest(const Message &rqst);
+	void serveBatch(const Message &rqst, vector<Message> &replies);
+	bool createKeyValue(const string &key, const string &value, ReplicaType replica, const Version &version);
+	string readKey(const string &key, Version *version = NULL);
+	bool updateKeyValue(const string &key, const string &value, ReplicaType replica, const Version &version);
+
+	// hybrid logical clock stamping the writes this node coordinates
+	Version nextVersion();
+	void observe(const Version &version);
+	bool deleteKey(const string &key);
 
 	// stabilization protocol - handle multiple failures
 	void stabilizationProtocol();
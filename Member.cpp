@@ -152,7 +152,13 @@ Member::Member(const Member &anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
-	this->myPos = anotherMember.myPos;
+	this->memberIndex = anotherMember.memberIndex;
+	this->memberVersion = anotherMember.memberVersion;
+	// myPos must point into our own copy of the table
+	int myIndex = this->findMember(*(int *)(&this->addr.addr), *(short *)(&this->addr.addr[4]));
+	if (myIndex >= 0) {
+		this->myPos = this->memberList.begin() + myIndex;
+	}
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
 }
@@ -170,8 +176,115 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
-	this->myPos = anotherMember.myPos;
+	this->memberIndex = anotherMember.memberIndex;
+	this->memberVersion = anotherMember.memberVersion;
+	// myPos must point into our own copy of the table
+	int myIndex = this->findMember(*(int *)(&this->addr.addr), *(short *)(&this->addr.addr[4]));
+	if (myIndex >= 0) {
+		this->myPos = this->memberList.begin() + myIndex;
+	}
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
 	return *this;
 }
+
+/**
+ * FUNCTION NAME: findMember
+ *
+ * DESCRIPTION: Position of the member in memberList
+ *
+ * RETURNS:
+ * index into memberList, -1 if the member is unknown
+ */
+int Member::findMember(int id, short port) {
+	FlatHashMap<long long, int>::iterator iter = memberIndex.find(memberKey(id, port));
+	return iter == memberIndex.end() ? -1 : iter->second;
+}
+
+/**
+ * FUNCTION NAME: addMember
+ *
+ * DESCRIPTION: Insert a new entry at its (id, port) position, keeping memberList ordered
+ * 				Only the entries after it move, their positions in memberIndex are shifted
+ */
+void Member::addMember(const MemberListEntry &entry) {
+	int myIndex = findMember(*(int *)(&addr.addr), *(short *)(&addr.addr[4]));
+	// binary search for the first entry ordered after the new one
+	int lo = 0, hi = memberList.size();
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		const MemberListEntry &other = memberList[mid];
+		if (other.id < entry.id || (other.id == entry.id && other.port < entry.port)) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	memberList.insert(memberList.begin() + lo, entry);
+	for (unsigned int i = lo + 1; i < memberList.size(); ++i) {
+		memberIndex[memberKey(memberList[i].id, memberList[i].port)] = i;
+	}
+	memberIndex.emplace(memberKey(entry.id, entry.port), lo);
+	if (entry.id == *(int *)(&addr.addr) && entry.port == *(short *)(&addr.addr[4])) {
+		myIndex = lo;
+	} else if (myIndex >= lo) {
+		++myIndex;
+	}
+	// the insert may have reallocated the table, myPos is rebuilt from its index
+	if (myIndex >= 0) {
+		myPos = memberList.begin() + myIndex;
+	}
+	nnb = memberList.size();
+	++memberVersion;
+}
+
+/**
+ * FUNCTION NAME: removeMember
+ *
+ * DESCRIPTION: Erase the entry at index, the positions of the entries after it are shifted
+ */
+void Member::removeMember(int index) {
+	int myIndex = findMember(*(int *)(&addr.addr), *(short *)(&addr.addr[4]));
+	memberIndex.erase(memberKey(memberList[index].id, memberList[index].port));
+	memberList.erase(memberList.begin() + index);
+	for (unsigned int i = index; i < memberList.size(); ++i) {
+		memberIndex[memberKey(memberList[i].id, memberList[i].port)] = i;
+	}
+	if (myIndex > index) {
+		myPos = memberList.begin() + (myIndex - 1);
+	} else if (myIndex >= 0 && myIndex < index) {
+		myPos = memberList.begin() + myIndex;
+	}
+	nnb = memberList.size();
+	++memberVersion;
+}
+
+/**
+ * FUNCTION NAME: clearMembers
+ *
+ * DESCRIPTION: Empty the membership table
+ */
+void Member::clearMembers() {
+	memberList.clear();
+	reindexMembers();
+}
+
+/**
+ * FUNCTION NAME: reindexMembers
+ *
+ * DESCRIPTION: Rebuild memberIndex, myPos and nnb after entries were added or removed
+ * 				memberList must already be ordered
+ */
+void Member::reindexMembers() {
+	memberIndex.clear();
+	memberIndex.reserve(memberList.size());
+	for (unsigned int i = 0; i < memberList.size(); ++i) {
+		memberIndex.emplace(memberKey(memberList[i].id, memberList[i].port), i);
+	}
+	int myIndex = findMember(*(int *)(&addr.addr), *(short *)(&addr.addr[4]));
+	if (myIndex >= 0) {
+		myPos = memberList.begin() + myIndex;
+	}
+	nnb = memberList.size();
+	++memberVersion;
+}
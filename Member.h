@@ -8,6 +8,7 @@
 #define MEMBER_H_
 
 #include "stdincludes.h"
+#include "FlatHashMap.h"
 
 /**
  * CLASS NAME: q_elt
@@ -104,10 +105,14 @@ public:
 	int pingCounter;
 	// counter for ping timeout
 	int timeOutCounter;
-	// Membership table
+	// Membership table, ordered by (id, port)
 	vector<MemberListEntry> memberList;
 	// My position in the membership table
 	vector<MemberListEntry>::iterator myPos;
+	// Position of every entry of memberList, keyed by memberKey(id, port)
+	FlatHashMap<long long, int> memberIndex;
+	// Bumped whenever an entry is added to or removed from memberList
+	unsigned long memberVersion;
 	// Queue for failure detection messages
 	queue<q_elt> mp1q;
 	// Queue for KVstore messages
@@ -115,11 +120,20 @@ public:
 	/**
 	 * Constructor
 	 */
-	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0) {}
+	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0), memberVersion(0) {}
 	// copy constructor
 	Member(const Member &anotherMember);
 	// Assignment operator overloading
 	Member& operator =(const Member &anotherMember);
+	static long long memberKey(int id, short port) {
+		return ((long long)id << 16) | (unsigned short)port;
+	}
+	// membership table maintenance
+	int findMember(int id, short port);
+	void addMember(const MemberListEntry &entry);
+	void removeMember(int index);
+	void clearMembers();
+	void reindexMembers();
 	virtual ~Member() {}
 };
 
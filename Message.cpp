@@ -5,24 +5,424 @@
  **********************************/
 #include "Message.h"
 
+// delimiter of the text codec
+static const string delimiter = "::";
+
+/**
+ * FUNCTION NAME: putVarint
+ *
+ * DESCRIPTION: Append an unsigned integer (up to 64 bits) in LEB128 form (7 bits per byte)
+ */
+static void putVarint(string &out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back((char)((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.push_back((char)value);
+}
+
+/**
+ * FUNCTION NAME: getVarint
+ *
+ * DESCRIPTION: Read a LEB128 integer (up to 64 bits), never reading past end
+ * 				An integer cut off by end clears valid
+ */
+static uint64_t getVarint(const char *&pos, const char *end, bool &valid) {
+	uint64_t value = 0;
+	int shift = 0;
+	while (shift < 64) {
+		if (pos >= end) {
+			valid = false;
+			break;
+		}
+		unsigned char byte = (unsigned char)*pos++;
+		value |= (uint64_t)(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			break;
+		}
+		shift += 7;
+	}
+	return value;
+}
+
+/**
+ * FUNCTION NAME: putBytes
+ *
+ * DESCRIPTION: Append a length-prefixed byte string
+ */
+static void putBytes(string &out, const string &bytes) {
+	putVarint(out, bytes.size());
+	out.append(bytes);
+}
+
+/**
+ * FUNCTION NAME: getBytes
+ *
+ * DESCRIPTION: Slice a length-prefixed byte string
+ * 				A length running past end clears valid and yields an empty slice
+ */
+static StringView getBytes(const char *&pos, const char *end, bool &valid) {
+	uint64_t len = getVarint(pos, end, valid);
+	if (!valid || len > (uint64_t)(end - pos)) {
+		valid = false;
+		pos = end;
+		return StringView(end, 0);
+	}
+	StringView bytes(pos, len);
+	pos += len;
+	return bytes;
+}
+
+/**
+ * FUNCTION NAME: putVersion
+ *
+ * DESCRIPTION: Append a version as three varints (wall, logical, node)
+ */
+static void putVersion(string &out, const Version &version) {
+	putVarint(out, (uint64_t)version.wall);
+	putVarint(out, (unsigned int)version.logical);
+	putVarint(out, (unsigned int)version.node);
+}
+
+/**
+ * FUNCTION NAME: getVersion
+ *
+ * DESCRIPTION: Read a version written by putVersion, a truncated version clears valid
+ */
+static Version getVersion(const char *&pos, const char *end, bool &valid) {
+	Version version;
+	version.wall = (long)getVarint(pos, end, valid);
+	version.logical = (int)getVarint(pos, end, valid);
+	version.node = (int)getVarint(pos, end, valid);
+	return version;
+}
+
+/**
+ * FUNCTION NAME: nextField
+ *
+ * DESCRIPTION: Slice the text field starting at pos and move pos past its delimiter
+ */
+static StringView nextField(const char *&pos, const char *end) {
+	const char *start = pos;
+	while (pos < end && !(pos + 1 < end && pos[0] == ':' && pos[1] == ':')) {
+		++pos;
+	}
+	StringView field(start, pos - start);
+	pos = (pos < end) ? pos + delimiter.size() : end;
+	return field;
+}
+
+/**
+ * FUNCTION NAME: toInt
+ *
+ * DESCRIPTION: Parse a decimal integer from a slice, stopping at the first non digit
+ */
+static int toInt(StringView field, size_t *used = NULL) {
+	size_t i = 0;
+	bool negative = (field.size && field.data[0] == '-');
+	int value = 0;
+	if (negative) {
+		++i;
+	}
+	while (i < field.size && field.data[i] >= '0' && field.data[i] <= '9') {
+		value = value * 10 + (field.data[i] - '0');
+		++i;
+	}
+	if (used) {
+		*used = i;
+	}
+	return negative ? -value : value;
+}
+
+/**
+ * FUNCTION NAME: toUnsigned
+ *
+ * DESCRIPTION: Parse an unsigned 64-bit decimal from a slice
+ */
+static uint64_t toUnsigned(StringView field) {
+	uint64_t value = 0;
+	for (size_t i = 0; i < field.size && field.data[i] >= '0' && field.data[i] <= '9'; ++i) {
+		value = value * 10 + (field.data[i] - '0');
+	}
+	return value;
+}
+
+/**
+ * Constructor
+ */
+// parse the wire form produced by Message::encode() without copying key or value
+MessageView::MessageView(const char *data, int size) {
+	valid = true;
+	type = REPLY;
+	transID = 0;
+	memset(fromAddr.addr, 0, sizeof(fromAddr.addr));
+	replica = RESERVED;
+	success = false;
+	digestOnly = false;
+	digest = MSG_DIGEST_NONE;
+	version = Version();
+#if MSG_CODEC == MSG_CODEC_BINARY
+	parseBinary(data, size);
+#else
+	parseText(data, size);
+#endif
+}
+
+/**
+ * FUNCTION NAME: parseText
+ *
+ * DESCRIPTION: Slice the fields of the text codec (see Message::parseText)
+ */
+void MessageView::parseText(const char *data, int size) {
+	if (size <= 0) {
+		valid = false;
+		return;
+	}
+	const char *pos = data;
+	const char *end = data + size;
+	transID = toInt(nextField(pos, end));
+	// fromAddr is "id:port"
+	StringView addr = nextField(pos, end);
+	size_t used = 0;
+	int id = toInt(addr, &used);
+	short port = 0;
+	if (used < addr.size) {
+		port = (short)toInt(StringView(addr.data + used + 1, addr.size - used - 1));
+	}
+	memcpy(&fromAddr.addr[0], &id, sizeof(int));
+	memcpy(&fromAddr.addr[4], &port, sizeof(short));
+	type = static_cast<MessageType>(toInt(nextField(pos, end)));
+	switch(type){
+		case CREATE:
+		case UPDATE:
+			key = nextField(pos, end);
+			value = nextField(pos, end);
+			if (pos < end)
+				replica = static_cast<ReplicaType>(toInt(nextField(pos, end)));
+			if (pos < end)
+				parseTextVersion(pos, end);
+			break;
+		case READ:
+			key = nextField(pos, end);
+			if (pos < end)
+				digestOnly = (nextField(pos, end).toString() == "1");
+			break;
+		case DELETE:
+			key = nextField(pos, end);
+			break;
+		case REPLY:
+			success = (nextField(pos, end).toString() == "1");
+			break;
+		case READREPLY:
+			value = nextField(pos, end);
+			if (pos < end)
+				parseTextVersion(pos, end);
+			if (pos < end) {
+				digestOnly = true;
+				digest = toUnsigned(nextField(pos, end));
+			}
+			break;
+		case BATCH:
+		case BATCHREPLY: {
+			int count = toInt(nextField(pos, end));
+			for (int i = 0; i < count && pos < end; ++i) {
+				BatchOpView op;
+				op.type = type;
+				op.replica = RESERVED;
+				op.success = false;
+				if (type == BATCH) {
+					op.type = static_cast<MessageType>(toInt(nextField(pos, end)));
+					op.replica = static_cast<ReplicaType>(toInt(nextField(pos, end)));
+					op.index = toInt(nextField(pos, end));
+					op.key = nextField(pos, end);
+				} else {
+					op.index = toInt(nextField(pos, end));
+					op.success = (nextField(pos, end).toString() == "1");
+				}
+				op.value = nextField(pos, end);
+				op.version.wall = (long)toUnsigned(nextField(pos, end));
+				op.version.logical = toInt(nextField(pos, end));
+				op.version.node = toInt(nextField(pos, end));
+				ops.push_back(op);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+/**
+ * FUNCTION NAME: parseTextVersion
+ *
+ * DESCRIPTION: Slice the three version fields of the text codec
+ */
+void MessageView::parseTextVersion(const char *&pos, const char *end) {
+	version.wall = (long)toUnsigned(nextField(pos, end));
+	version.logical = toInt(nextField(pos, end));
+	version.node = toInt(nextField(pos, end));
+}
+
+/**
+ * FUNCTION NAME: parseBinary
+ *
+ * DESCRIPTION: Slice the fields of the binary codec
+ */
+// header: type(1) flags(1) replica(1) fromAddr(6), followed by varint transID and
+// CREATE/UPDATE: key, value, version
+// READ/DELETE: key (a digest READ sets the digest flag)
+// REPLY: (success is a header flag)
+// READREPLY: value, or its 8-byte little-endian digest when the digest flag is set, version
+// BATCH: varint count, then per sub-operation type(1) replica(1) varint index, key, value, version
+// BATCHREPLY: varint count, then per sub-operation varint index, flags(1), value, version
+// where key and value are prefixed with their varint length and a version is three varints
+void MessageView::parseBinary(const char *data, int size) {
+	// a truncated header or field cannot be parsed, the receiver drops the message
+	if (size < MSG_HEADER_SIZE) {
+		valid = false;
+		return;
+	}
+	const char *pos = data + MSG_HEADER_SIZE;
+	const char *end = data + size;
+	type = static_cast<MessageType>((unsigned char)data[0]);
+	success = (data[1] & MSG_FLAG_SUCCESS) != 0;
+	digestOnly = (data[1] & MSG_FLAG_DIGEST) != 0;
+	replica = static_cast<ReplicaType>((unsigned char)data[2]);
+	memcpy(fromAddr.addr, data + 3, sizeof(fromAddr.addr));
+	transID = (int)getVarint(pos, end, valid);
+	switch(type){
+		case CREATE:
+		case UPDATE:
+			key = getBytes(pos, end, valid);
+			value = getBytes(pos, end, valid);
+			version = getVersion(pos, end, valid);
+			break;
+		case READ:
+		case DELETE:
+			key = getBytes(pos, end, valid);
+			break;
+		case REPLY:
+			break;
+		case READREPLY:
+			if (digestOnly) {
+				if (end - pos < 8) {
+					valid = false;
+					break;
+				}
+				for (int i = 0; i < 8; ++i) {
+					digest |= (uint64_t)(unsigned char)*pos++ << (8 * i);
+				}
+			} else {
+				value = getBytes(pos, end, valid);
+			}
+			version = getVersion(pos, end, valid);
+			break;
+		case BATCH:
+		case BATCHREPLY: {
+			uint64_t count = getVarint(pos, end, valid);
+			// a count larger than the sub-operations present runs out of bytes and is dropped
+			for (uint64_t i = 0; i < count && valid; ++i) {
+				BatchOpView op;
+				op.type = type;
+				op.replica = RESERVED;
+				op.success = false;
+				if (type == BATCH) {
+					if (end - pos < 2) {
+						valid = false;
+						break;
+					}
+					op.type = static_cast<MessageType>((unsigned char)*pos++);
+					op.replica = static_cast<ReplicaType>((unsigned char)*pos++);
+					op.index = (int)getVarint(pos, end, valid);
+					op.key = getBytes(pos, end, valid);
+				} else {
+					op.index = (int)getVarint(pos, end, valid);
+					if (pos >= end) {
+						valid = false;
+						break;
+					}
+					op.success = (*pos++ & MSG_FLAG_SUCCESS) != 0;
+				}
+				op.value = getBytes(pos, end, valid);
+				op.version = getVersion(pos, end, valid);
+				ops.push_back(op);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+/**
+ * Constructor
+ */
+Message::Message(string message){
+	parseText(message);
+}
+
 /**
  * Constructor
  */
-// transID::fromAddr::CREATE::key::value::ReplicaType
-// transID::fromAddr::READ::key
-// transID::fromAddr::UPDATE::key::value::ReplicaType
+// construct a message from the wire form produced by encode()
+Message::Message(const char *data, int size){
+	*this = Message(MessageView(data, size));
+}
+
+/**
+ * Constructor
+ */
+// copy the fields out of a parsed view
+Message::Message(const MessageView &view){
+	type = view.type;
+	replica = view.replica;
+	key.assign(view.key.data, view.key.size);
+	value.assign(view.value.data, view.value.size);
+	fromAddr = view.fromAddr;
+	transID = view.transID;
+	success = view.success;
+	digestOnly = view.digestOnly;
+	digest = view.digest;
+	version = view.version;
+	ops.resize(view.ops.size());
+	for (unsigned int i = 0; i < view.ops.size(); ++i) {
+		const BatchOpView &op = view.ops[i];
+		ops[i].type = op.type;
+		ops[i].replica = op.replica;
+		ops[i].index = op.index;
+		ops[i].success = op.success;
+		ops[i].key.assign(op.key.data, op.key.size);
+		ops[i].value.assign(op.value.data, op.value.size);
+		ops[i].version = op.version;
+	}
+}
+
+/**
+ * FUNCTION NAME: parseText
+ *
+ * DESCRIPTION: Fill the fields from the text codec
+ */
+// transID::fromAddr::CREATE::key::value::ReplicaType::wall::logical::node
+// transID::fromAddr::READ::key[::1 for a digest read]
+// transID::fromAddr::UPDATE::key::value::ReplicaType::wall::logical::node
 // transID::fromAddr::DELETE::key
 // transID::fromAddr::REPLY::sucess
-// transID::fromAddr::READREPLY::value
-Message::Message(string message){
-	this->delimiter = "::";
+// transID::fromAddr::READREPLY::value::wall::logical::node[::digest]
+// transID::fromAddr::BATCH::count[::type::ReplicaType::index::key::value::wall::logical::node]...
+// transID::fromAddr::BATCHREPLY::count[::index::sucess::value::wall::logical::node]...
+void Message::parseText(const string &message){
+	replica = RESERVED;
+	success = false;
+	digestOnly = false;
+	digest = MSG_DIGEST_NONE;
+	version = Version();
 	vector<string> tuple;
 	size_t pos = message.find(delimiter);
 	size_t start = 0;
 	while (pos != string::npos) {
 		string field = message.substr(start, pos-start);
 		tuple.push_back(field);
-		start = pos + 2;
+		start = pos + delimiter.size();
 		pos = message.find(delimiter, start);
 	}
 	tuple.push_back(message.substr(start));
@@ -38,8 +438,17 @@ Message::Message(string message){
 			value = tuple.at(4);
 			if (tuple.size() > 5)
 				replica = static_cast<ReplicaType>(stoi(tuple.at(5)));
+			if (tuple.size() > 8) {
+				version.wall = stol(tuple.at(6));
+				version.logical = stoi(tuple.at(7));
+				version.node = stoi(tuple.at(8));
+			}
 			break;
 		case READ:
+			key = tuple.at(3);
+			if (tuple.size() > 4)
+				digestOnly = (tuple.at(4) == "1");
+			break;
 		case DELETE:
 			key = tuple.at(3);
 			break;
@@ -51,6 +460,43 @@ Message::Message(string message){
 			break;
 		case READREPLY:
 			value = tuple.at(3);
+			if (tuple.size() > 6) {
+				version.wall = stol(tuple.at(4));
+				version.logical = stoi(tuple.at(5));
+				version.node = stoi(tuple.at(6));
+			}
+			if (tuple.size() > 7) {
+				digestOnly = true;
+				digest = stoull(tuple.at(7));
+			}
+			break;
+		case BATCH:
+		case BATCHREPLY: {
+			int count = stoi(tuple.at(3));
+			size_t field = 4;
+			for (int i = 0; i < count; ++i) {
+				BatchOp op;
+				op.type = type;
+				op.replica = RESERVED;
+				op.success = false;
+				if (type == BATCH) {
+					op.type = static_cast<MessageType>(stoi(tuple.at(field++)));
+					op.replica = static_cast<ReplicaType>(stoi(tuple.at(field++)));
+					op.index = stoi(tuple.at(field++));
+					op.key = tuple.at(field++);
+				} else {
+					op.index = stoi(tuple.at(field++));
+					op.success = (tuple.at(field++) == "1");
+				}
+				op.value = tuple.at(field++);
+				op.version.wall = stol(tuple.at(field++));
+				op.version.logical = stoi(tuple.at(field++));
+				op.version.node = stoi(tuple.at(field++));
+				ops.push_back(op);
+			}
+			break;
+		}
+		default:
 			break;
 	}
 }
@@ -60,7 +506,10 @@ Message::Message(string message){
  */
 // construct a create or update message
 Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key, string _value, ReplicaType _replica){
-	this->delimiter = "::";
+	digestOnly = false;
+	digest = MSG_DIGEST_NONE;
+	version = Version();
+	success = false;
 	transID = _transID;
 	fromAddr = _fromAddr;
 	type = _type;
@@ -73,7 +522,6 @@ Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key
  * Constructor
  */
 Message::Message(const Message& anotherMessage) {
-	this->delimiter = anotherMessage.delimiter;
 	this->fromAddr = anotherMessage.fromAddr;
 	this->key = anotherMessage.key;
 	this->replica = anotherMessage.replica;
@@ -81,13 +529,21 @@ Message::Message(const Message& anotherMessage) {
 	this->transID = anotherMessage.transID;
 	this->type = anotherMessage.type;
 	this->value = anotherMessage.value;
+	this->digestOnly = anotherMessage.digestOnly;
+	this->digest = anotherMessage.digest;
+	this->version = anotherMessage.version;
+	this->ops = anotherMessage.ops;
 }
 
 /**
  * Constructor
  */
 Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key, string _value){
-	this->delimiter = "::";
+	digestOnly = false;
+	digest = MSG_DIGEST_NONE;
+	version = Version();
+	replica = RESERVED;
+	success = false;
 	transID = _transID;
 	fromAddr = _fromAddr;
 	type = _type;
@@ -100,7 +556,11 @@ Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key
  */
 // construct a read or delete message
 Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key){
-	this->delimiter = "::";
+	digestOnly = false;
+	digest = MSG_DIGEST_NONE;
+	version = Version();
+	replica = RESERVED;
+	success = false;
 	transID = _transID;
 	fromAddr = _fromAddr;
 	type = _type;
@@ -112,7 +572,10 @@ Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key
  */
 // construct reply message
 Message::Message(int _transID, Address _fromAddr, MessageType _type, bool _success){
-	this->delimiter = "::";
+	digestOnly = false;
+	digest = MSG_DIGEST_NONE;
+	version = Version();
+	replica = RESERVED;
 	transID = _transID;
 	fromAddr = _fromAddr;
 	type = _type;
@@ -124,13 +587,49 @@ Message::Message(int _transID, Address _fromAddr, MessageType _type, bool _succe
  */
 // construct read reply message
 Message::Message(int _transID, Address _fromAddr, string _value){
-	this->delimiter = "::";
+	digestOnly = false;
+	digest = MSG_DIGEST_NONE;
+	version = Version();
+	replica = RESERVED;
+	success = false;
 	transID = _transID;
 	fromAddr = _fromAddr;
 	type = READREPLY;
 	value = _value;
 }
 
+/**
+ * Constructor
+ */
+// construct an empty batch or batch reply message, see addOp
+Message::Message(int _transID, Address _fromAddr, MessageType _type){
+	digestOnly = false;
+	digest = MSG_DIGEST_NONE;
+	version = Version();
+	replica = RESERVED;
+	success = false;
+	transID = _transID;
+	fromAddr = _fromAddr;
+	type = _type;
+}
+
+/**
+ * FUNCTION NAME: addOp
+ *
+ * DESCRIPTION: Append a sub-operation to a batch or a result to a batch reply
+ */
+void Message::addOp(MessageType _type, ReplicaType _replica, int _index, bool _success, const string &_key, const string &_value, const Version &_version){
+	BatchOp op;
+	op.type = _type;
+	op.replica = _replica;
+	op.index = _index;
+	op.success = _success;
+	op.key = _key;
+	op.value = _value;
+	op.version = _version;
+	ops.push_back(op);
+}
+
 /**
  * FUNCTION NAME: toString
  *
@@ -141,9 +640,13 @@ string Message::toString(){
 	switch(type){
 		case CREATE:
 		case UPDATE:
-			message += key + delimiter + value + delimiter + to_string(replica);
+			message += key + delimiter + value + delimiter + to_string(replica) + delimiter + versionString();
 			break;
 		case READ:
+			message += key;
+			if (digestOnly)
+				message += delimiter + "1";
+			break;
 		case DELETE:
 			message += key;
 			break;
@@ -154,7 +657,104 @@ string Message::toString(){
 				message += "0";
 			break;
 		case READREPLY:
-			message += value;
+			message += value + delimiter + versionString();
+			if (digestOnly)
+				message += delimiter + to_string(digest);
+			break;
+		case BATCH:
+		case BATCHREPLY:
+			message += to_string(ops.size());
+			for (const BatchOp &op : ops) {
+				if (type == BATCH) {
+					message += delimiter + to_string(op.type) + delimiter + to_string(op.replica) + delimiter + to_string(op.index) + delimiter + op.key;
+				} else {
+					message += delimiter + to_string(op.index) + delimiter + (op.success ? "1" : "0");
+				}
+				message += delimiter + op.value + delimiter + to_string(op.version.wall) + delimiter + to_string(op.version.logical) + delimiter + to_string(op.version.node);
+			}
+			break;
+		default:
+			break;
+	}
+	return message;
+}
+
+/**
+ * FUNCTION NAME: versionString
+ *
+ * DESCRIPTION: Version in the text codec, "wall::logical::node"
+ */
+string Message::versionString(){
+	return to_string(version.wall) + delimiter + to_string(version.logical) + delimiter + to_string(version.node);
+}
+
+/**
+ * FUNCTION NAME: encode
+ *
+ * DESCRIPTION: Serialized Message in the wire format selected by MSG_CODEC
+ */
+string Message::encode(){
+#if MSG_CODEC == MSG_CODEC_BINARY
+	return toBinary();
+#else
+	return toString();
+#endif
+}
+
+/**
+ * FUNCTION NAME: toBinary
+ *
+ * DESCRIPTION: Serialized Message in the binary format (see parseBinary)
+ */
+string Message::toBinary(){
+	string message;
+	message.reserve(MSG_HEADER_SIZE + 10 + key.size() + value.size());
+	message.push_back((char)type);
+	message.push_back((char)(((type == REPLY && success) ? MSG_FLAG_SUCCESS : 0) | (digestOnly ? MSG_FLAG_DIGEST : 0)));
+	message.push_back((char)((type == CREATE || type == UPDATE) ? replica : RESERVED));
+	message.append(fromAddr.addr, sizeof(fromAddr.addr));
+	putVarint(message, (unsigned int)transID);
+	switch(type){
+		case CREATE:
+		case UPDATE:
+			putBytes(message, key);
+			putBytes(message, value);
+			putVersion(message, version);
+			break;
+		case READ:
+		case DELETE:
+			putBytes(message, key);
+			break;
+		case REPLY:
+			break;
+		case READREPLY:
+			if (digestOnly) {
+				for (int i = 0; i < 8; ++i) {
+					message.push_back((char)(digest >> (8 * i)));
+				}
+			} else {
+				putBytes(message, value);
+			}
+			putVersion(message, version);
+			break;
+		case BATCH:
+		case BATCHREPLY:
+			putVarint(message, ops.size());
+			for (const BatchOp &op : ops) {
+				if (type == BATCH) {
+					message.push_back((char)op.type);
+					message.push_back((char)op.replica);
+					putVarint(message, (unsigned int)op.index);
+					putBytes(message, op.key);
+				} else {
+					putVarint(message, (unsigned int)op.index);
+					message.push_back((char)(op.success ? MSG_FLAG_SUCCESS : 0));
+				}
+				putBytes(message, op.value);
+				putVersion(message, op.version);
+			}
+			break;
+		default:
 			break;
 	}
 	return message;
@@ -164,7 +764,6 @@ string Message::toString(){
  * Assignment operator overloading
  */
 Message& Message::operator =(const Message& anotherMessage) {
-	this->delimiter = anotherMessage.delimiter;
 	this->fromAddr = anotherMessage.fromAddr;
 	this->key = anotherMessage.key;
 	this->replica = anotherMessage.replica;
@@ -172,5 +771,85 @@ Message& Message::operator =(const Message& anotherMessage) {
 	this->transID = anotherMessage.transID;
 	this->type = anotherMessage.type;
 	this->value = anotherMessage.value;
+	this->digestOnly = anotherMessage.digestOnly;
+	this->digest = anotherMessage.digest;
+	this->version = anotherMessage.version;
+	this->ops = anotherMessage.ops;
 	return *this;
 }
+
+/**
+ * Constructor
+ */
+Envelope::Envelope() {
+	clear();
+}
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Empty the envelope, keeping its buffer for the next messages
+ */
+void Envelope::clear() {
+	data.assign(1, (char)ENVELOPE);
+	count = 0;
+	firstType = ENVELOPE;
+	firstOffset = 0;
+}
+
+/**
+ * FUNCTION NAME: add
+ *
+ * DESCRIPTION: Append an encoded message
+ */
+void Envelope::add(const string &encoded, MessageType type) {
+	putVarint(data, encoded.size());
+	if (count++ == 0) {
+		firstType = type;
+		firstOffset = data.size();
+	}
+	data.append(encoded);
+}
+
+/**
+ * FUNCTION NAME: sizeWith
+ *
+ * DESCRIPTION: Size of the envelope once the encoded message is added
+ */
+size_t Envelope::sizeWith(const string &encoded) {
+	string prefix;
+	putVarint(prefix, encoded.size());
+	return data.size() + prefix.size() + encoded.size();
+}
+
+/**
+ * FUNCTION NAME: payload
+ *
+ * DESCRIPTION: What goes on the network: the only message as it is, or the whole envelope
+ */
+StringView Envelope::payload() {
+	if (count == 1) {
+		return StringView(data.data() + firstOffset, data.size() - firstOffset);
+	}
+	return StringView(data.data(), data.size());
+}
+
+/**
+ * FUNCTION NAME: isEnvelope
+ *
+ * DESCRIPTION: Whether a received buffer is an envelope rather than a single message
+ */
+bool Envelope::isEnvelope(const char *data, int size) {
+	return size > 0 && (unsigned char)data[0] == (unsigned char)ENVELOPE;
+}
+
+/**
+ * FUNCTION NAME: nextFrame
+ *
+ * DESCRIPTION: Slice the next message of an envelope, pos starts past the ENVELOPE byte
+ * 				A truncated frame comes back empty, which the receiver drops
+ */
+StringView Envelope::nextFrame(const char *&pos, const char *end) {
+	bool valid(true);
+	return getBytes(pos, end, valid);
+}
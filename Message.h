@@ -7,13 +7,115 @@
 #define MESSAGE_H_
 
 #include "stdincludes.h"
+#include <stdint.h>
 #include "Member.h"
 #include "common.h"
 
+/**
+ * Macros
+ */
+// Wire codecs, pick one at build time with -DMSG_CODEC=<codec>
+#define MSG_CODEC_TEXT 0
+#define MSG_CODEC_BINARY 1
+#ifndef MSG_CODEC
+#define MSG_CODEC MSG_CODEC_BINARY
+#endif
+// Fixed part of the binary encoding: type, flags, replica and sender address
+#define MSG_HEADER_SIZE 9
+// Flag bits of the binary header
+#define MSG_FLAG_SUCCESS 0x01
+// READ asks for a digest, READREPLY carries one instead of the value
+#define MSG_FLAG_DIGEST 0x02
+// Digest of a missing key
+#define MSG_DIGEST_NONE 0
+
+/**
+ * CLASS NAME: StringView
+ *
+ * DESCRIPTION: Non-owning slice (pointer and length) of a buffer
+ */
+class StringView {
+public:
+	const char *data;
+	size_t size;
+	StringView(): data(NULL), size(0) {}
+	StringView(const char *data, size_t size): data(data), size(size) {}
+	bool empty() const {
+		return size == 0;
+	}
+	string toString() const {
+		return string(data, size);
+	}
+};
+
+/**
+ * STRUCT NAME: BatchOpView
+ *
+ * DESCRIPTION: Sub-operation of a BATCH or BATCHREPLY parsed in place, see BatchOp
+ */
+struct BatchOpView {
+	MessageType type;
+	ReplicaType replica;
+	int index;
+	bool success;
+	StringView key;
+	StringView value;
+	Version version;
+};
+
+/**
+ * STRUCT NAME: BatchOp
+ *
+ * DESCRIPTION: Sub-operation of a BATCH (type, replica, key, value and version as in a
+ * 				single-key request) or its result in the BATCHREPLY (success, value and version).
+ * 				index is the position of the key in the coordinator's batch, the reply echoes it
+ */
+struct BatchOp {
+	MessageType type;
+	ReplicaType replica;
+	int index;
+	bool success;
+	string key;
+	string value;
+	Version version;
+};
+
+/**
+ * CLASS NAME: MessageView
+ *
+ * DESCRIPTION: A message parsed in place from its wire form
+ * 				key and value point into the parsed buffer, which must outlive the view
+ */
+class MessageView {
+public:
+	MessageType type;
+	ReplicaType replica;
+	StringView key;
+	StringView value;
+	Address fromAddr;
+	int transID;
+	bool success;
+	bool digestOnly;
+	uint64_t digest;
+	Version version;
+	// sub-operations of a BATCH or BATCHREPLY
+	vector<BatchOpView> ops;
+	// false if the buffer is too short for the header or a field runs past its end
+	bool valid;
+	MessageView(const char *data, int size);
+
+private:
+	void parseText(const char *data, int size);
+	void parseBinary(const char *data, int size);
+	void parseTextVersion(const char *&pos, const char *end);
+};
+
 /**
  * CLASS NAME: Message
  *
  * DESCRIPTION: This class is used for message passing among nodes
+ * 				encode() and Message(data, size) use the wire codec selected by MSG_CODEC,
+ * 				toString() and Message(string) always use the "::" delimited text form
  */
 class Message{
 public:
@@ -24,10 +126,15 @@ public:
 	Address fromAddr;
 	int transID;
 	bool success; // success or not 
-	// delimiter
-	string delimiter;
+	bool digestOnly; // digest read request or reply
+	uint64_t digest;
+	Version version; // of the value written or read
+	vector<BatchOp> ops; // sub-operations of a BATCH or BATCHREPLY
 	// construct a message from a string
 	Message(string message);
+	// construct a message from its wire form
+	Message(const char *data, int size);
+	Message(const MessageView &view);
 	Message(const Message& anotherMessage);
 	// construct a create or update message
 	Message(int _transID, Address _fromAddr, MessageType _type, string _key, string _value);
@@ -38,9 +145,46 @@ public:
 	Message(int _transID, Address _fromAddr, MessageType _type, bool _success);
 	// construct read reply message
 	Message(int _transID, Address _fromAddr, string _value);
+	// construct an empty batch or batch reply message
+	Message(int _transID, Address _fromAddr, MessageType _type);
+	void addOp(MessageType _type, ReplicaType _replica, int _index, bool _success, const string &_key, const string &_value, const Version &_version);
 	Message& operator = (const Message& anotherMessage);
 	// serialize to a string
 	string toString();
+	// serialize to the wire form
+	string encode();
+
+private:
+	void parseText(const string &message);
+	string toBinary();
+	string versionString();
+};
+
+/**
+ * CLASS NAME: Envelope
+ *
+ * DESCRIPTION: Encoded messages to one node coalesced into one network message: the ENVELOPE
+ * 				type byte, then every message prefixed with its varint length. The framing is the
+ * 				same for both codecs, a text message never starts with that byte
+ */
+class Envelope {
+public:
+	Address to;
+	// messages in the envelope and the type of the first one
+	int count;
+	MessageType firstType;
+	Envelope();
+	void clear();
+	void add(const string &encoded, MessageType type);
+	size_t sizeWith(const string &encoded);
+	StringView payload();
+	static bool isEnvelope(const char *data, int size);
+	static StringView nextFrame(const char *&pos, const char *end);
+
+private:
+	string data;
+	// offset of the first message, sent alone when it is the only one
+	size_t firstOffset;
 };
 
 #endif
@@ -30,7 +30,23 @@ Node::~Node() {}
  * DESCRIPTION: This function computes the hash code of the node address
  */
 void Node::computeHashCode() {
-	nodeHashCode = hashFunc(nodeAddress.addr)%RING_SIZE;
+	nodeHashCode = computeToken(0);
+}
+
+/**
+ * FUNCTION NAME: computeToken
+ *
+ * DESCRIPTION: Position of one of the node's virtual nodes on the 64-bit ring
+ * 				Same on every node and platform (see Hash.h)
+ */
+uint64_t Node::computeToken(int vnode) {
+	// the raw 6 address bytes followed by the vnode number in little-endian order
+	uint8_t seed[sizeof(nodeAddress.addr) + 4];
+	memcpy(seed, nodeAddress.addr, sizeof(nodeAddress.addr));
+	for (int i = 0; i < 4; ++i) {
+		seed[sizeof(nodeAddress.addr) + i] = (uint8_t)((unsigned int)vnode >> (8 * i));
+	}
+	return hashBytes(seed, sizeof(seed));
 }
 
 /**
@@ -57,12 +73,13 @@ bool Node::operator < (const Node& another) const {
 	return this->nodeHashCode < another.nodeHashCode;
 }
 
+// nodes are the same when their addresses are, tokens may collide
 bool Node::operator == (const Node& another) const {
-	return this->nodeHashCode == another.nodeHashCode;
+	return memcmp(this->nodeAddress.addr, another.nodeAddress.addr, sizeof(nodeAddress.addr)) == 0;
 }
 
 bool Node::operator != (const Node& another) const {
-	return this->nodeHashCode != another.nodeHashCode;
+	return !(*this == another);
 }
 
 /**
@@ -70,7 +87,7 @@ bool Node::operator != (const Node& another) const {
  *
  * DESCRIPTION: return hash code of the node
  */
-size_t Node::getHashCode() {
+uint64_t Node::getHashCode() {
 	return nodeHashCode;
 }
 
@@ -88,7 +105,7 @@ Address * Node::getAddress() {
  *
  * DESCRIPTION: set the hash code of the node
  */
-void Node::setHashCode(size_t hashCode) {
+void Node::setHashCode(uint64_t hashCode) {
 	this->nodeHashCode = hashCode;
 }
 
@@ -9,12 +9,13 @@
 
 #include "stdincludes.h"
 #include "Member.h"
+#include "Hash.h"
 
 class Node {
 public:
 	Address nodeAddress;
-	size_t nodeHashCode;
-	std::hash<string> hashFunc;
+	// token of the node's first virtual node
+	uint64_t nodeHashCode;
 	Node();
 	Node(Address address);
 	Node(const Node& another);
@@ -23,9 +24,10 @@ public:
 	bool operator == (const Node& another) const;
 	bool operator != (const Node& another) const;
 	void computeHashCode();
-	size_t getHashCode();
+	uint64_t computeToken(int vnode);
+	uint64_t getHashCode();
 	Address * getAddress();
-	void setHashCode(size_t hashCode);
+	void setHashCode(uint64_t hashCode);
 	void setAddress(Address address);
 	virtual ~Node();
 };
@@ -40,6 +40,91 @@ void Params::setparams(char *config_file) {
 		this->CRUDTEST = DELETE_TEST;
 	}
 
+	// optional tuning lines, in any order after the test case
+	char name[32];
+	VNODES = DEFAULT_VNODES;
+	NODE_WEIGHT.clear();
+	PLACEMENT = RING_PLACEMENT;
+	RF = DEFAULT_RF;
+	READ_QUORUM = DEFAULT_READ_QUORUM;
+	WRITE_QUORUM = DEFAULT_WRITE_QUORUM;
+	READ_LEVEL = QUORUM;
+	WRITE_LEVEL = QUORUM;
+	HEDGED_READS = 0;
+	HEDGE_PERCENTILE = DEFAULT_HEDGE_PERCENTILE;
+	DIGEST_READS = 0;
+	SMART_ROUTING = 0;
+	while ( fscanf(fp, " %31[^:]:", name) == 1 ) {
+		if ( 0 == strcmp(name, "VNODES") ) {
+			fscanf(fp, "%d", &VNODES);
+		}
+		else if ( 0 == strcmp(name, "NODE_WEIGHT") ) {
+			int id, weight;
+			if ( fscanf(fp, "%d %d", &id, &weight) == 2 ) {
+				NODE_WEIGHT[id] = weight;
+			}
+		}
+		else if ( 0 == strcmp(name, "PLACEMENT") ) {
+			char placement[16];
+			fscanf(fp, "%15s", placement);
+			if ( 0 == strcmp(placement, "JUMP") ) {
+				PLACEMENT = JUMP_PLACEMENT;
+			}
+			else if ( 0 == strcmp(placement, "RENDEZVOUS") ) {
+				PLACEMENT = RENDEZVOUS_PLACEMENT;
+			}
+			else {
+				PLACEMENT = RING_PLACEMENT;
+			}
+		}
+		else if ( 0 == strcmp(name, "RF") ) {
+			fscanf(fp, "%d", &RF);
+		}
+		else if ( 0 == strcmp(name, "READ_QUORUM") ) {
+			fscanf(fp, "%d", &READ_QUORUM);
+		}
+		else if ( 0 == strcmp(name, "WRITE_QUORUM") ) {
+			fscanf(fp, "%d", &WRITE_QUORUM);
+		}
+		else if ( 0 == strcmp(name, "HEDGED_READS") ) {
+			fscanf(fp, "%d", &HEDGED_READS);
+		}
+		else if ( 0 == strcmp(name, "HEDGE_PERCENTILE") ) {
+			fscanf(fp, "%d", &HEDGE_PERCENTILE);
+		}
+		else if ( 0 == strcmp(name, "DIGEST_READS") ) {
+			fscanf(fp, "%d", &DIGEST_READS);
+		}
+		else if ( 0 == strcmp(name, "SMART_ROUTING") ) {
+			fscanf(fp, "%d", &SMART_ROUTING);
+		}
+		else if ( 0 == strcmp(name, "READ_CONSISTENCY") || 0 == strcmp(name, "WRITE_CONSISTENCY") ) {
+			char level[16];
+			fscanf(fp, "%15s", level);
+			ConsistencyLevel parsed = QUORUM;
+			if ( 0 == strcmp(level, "ONE") ) {
+				parsed = ONE;
+			}
+			else if ( 0 == strcmp(level, "ALL") ) {
+				parsed = ALL;
+			}
+			if ( 0 == strcmp(name, "READ_CONSISTENCY") ) {
+				READ_LEVEL = parsed;
+			}
+			else {
+				WRITE_LEVEL = parsed;
+			}
+		}
+		else {
+			fscanf(fp, "%*[^\n]");
+		}
+	}
+	// a quorum needs at least one and at most all replicas
+	RF = max(1, min(RF, MAX_RF));
+	READ_QUORUM = max(1, min(READ_QUORUM, RF));
+	WRITE_QUORUM = max(1, min(WRITE_QUORUM, RF));
+	HEDGE_PERCENTILE = max(1, min(HEDGE_PERCENTILE, 100));
+
 	//printf("Parameters of the test case: %d %d %d %lf\n", MAX_NNB, SINGLE_FAILURE, DROP_MSG, MSG_DROP_PROB);
 
 	EN_GPSZ = MAX_NNB;
@@ -65,3 +150,33 @@ void Params::setparams(char *config_file) {
 int Params::getcurrtime(){
     return globaltime;
 }
+
+/**
+ * FUNCTION NAME: getvnodes
+ *
+ * DESCRIPTION: Number of virtual nodes the node id owns on the ring
+ */
+int Params::getvnodes(int id) {
+	map<int, int>::iterator iter = NODE_WEIGHT.find(id);
+	int weight = (iter == NODE_WEIGHT.end()) ? 1 : iter->second;
+	return max(1, VNODES * weight);
+}
+
+/**
+ * FUNCTION NAME: getquorum
+ *
+ * DESCRIPTION: Number of replies a read or a write at the given level waits for
+ */
+int Params::getquorum(ConsistencyLevel level, bool read) {
+	if ( level == DEFAULT_LEVEL ) {
+		level = read ? READ_LEVEL : WRITE_LEVEL;
+	}
+	switch ( level ) {
+		case ONE:
+			return 1;
+		case ALL:
+			return RF;
+		default:
+			return read ? READ_QUORUM : WRITE_QUORUM;
+	}
+}
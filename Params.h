@@ -11,7 +11,23 @@
 #include "Params.h"
 #include "Member.h"
 
+/**
+ * Macros
+ */
+// Virtual nodes of a physical node of weight 1
+#define DEFAULT_VNODES 16
+// Replicas of every key and the replies a read or a write waits for
+#define DEFAULT_RF 3
+#define DEFAULT_READ_QUORUM 2
+#define DEFAULT_WRITE_QUORUM 2
+// Replica indices travel in one byte next to RESERVED (255)
+#define MAX_RF 254
+#define DEFAULT_HEDGE_PERCENTILE 95
+
 enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
+enum placementTYPE { RING_PLACEMENT, JUMP_PLACEMENT, RENDEZVOUS_PLACEMENT };
+// replies a client request waits for: one replica, the configured quorum or every replica
+enum ConsistencyLevel { ONE, QUORUM, ALL, DEFAULT_LEVEL };
 
 /**
  * CLASS NAME: Params
@@ -32,9 +48,23 @@ public:
 	int allNodesJoined;
 	short PORTNUM;
 	int CRUDTEST;
+	int VNODES;					// virtual nodes per unit of weight
+	map<int, int> NODE_WEIGHT;	// weight of a node id, 1 when absent
+	placementTYPE PLACEMENT;	// replica placement strategy
+	int RF;						// replicas of every key (N)
+	int READ_QUORUM;			// replies a read waits for (R)
+	int WRITE_QUORUM;			// replies a create, update or delete waits for (W)
+	ConsistencyLevel READ_LEVEL;	// level of reads that do not pick one
+	ConsistencyLevel WRITE_LEVEL;	// level of writes that do not pick one
+	int HEDGED_READS;			// read from the fastest replicas first and hedge to the others
+	int HEDGE_PERCENTILE;		// a replica is late past this percentile of its round-trip times
+	int DIGEST_READS;			// one replica returns the value, the others its digest
+	int SMART_ROUTING;			// the client sends every request to a replica of its key
 	Params();
 	void setparams(char *);
 	int getcurrtime();
+	int getvnodes(int id);
+	int getquorum(ConsistencyLevel level, bool read);
 };
 
 #endif /* _PARAMS_H_ */
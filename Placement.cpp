@@ -0,0 +1,64 @@
+/**********************************
+ * FILE NAME: Placement.cpp
+ *
+ * DESCRIPTION: Placement class definition
+ **********************************/
+
+#include "Placement.h"
+#include "Ring.h"
+#include "JumpHash.h"
+#include "Rendezvous.h"
+
+/**
+ * constructor
+ */
+Placement::Placement(): replicas(0) {}
+
+/**
+ * Destructor
+ */
+Placement::~Placement() {}
+
+/**
+ * FUNCTION NAME: create
+ *
+ * DESCRIPTION: Empty placement of the given strategy, caller owns it
+ */
+Placement * Placement::create(placementTYPE type) {
+	switch (type) {
+		case JUMP_PLACEMENT:
+			return new JumpHash();
+		case RENDEZVOUS_PLACEMENT:
+			return new Rendezvous();
+		default:
+			return new Ring();
+	}
+}
+
+/**
+ * FUNCTION NAME: setMembers
+ *
+ * DESCRIPTION: Record the membership list and index it by address
+ */
+void Placement::setMembers(const vector<Node> &members, int replicas) {
+	this->replicas = replicas;
+	this->members = members;
+	memberIndex.clear();
+	for (unsigned int i = 0; i < this->members.size(); ++i) {
+		Address &addr = this->members[i].nodeAddress;
+		memberIndex.emplace(Member::memberKey(*(int *)(&addr.addr), *(short *)(&addr.addr[4])), i);
+	}
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Position of the physical node in the membership list (see member())
+ *
+ * RETURNS:
+ * index of the member, -1 if the node is not a member
+ */
+int Placement::find(Address &address) {
+	FlatHashMap<long long, int>::iterator iter = memberIndex.find(Member::memberKey(*(int *)(&address.addr), *(short *)(&address.addr[4])));
+	return iter == memberIndex.end() ? -1 : iter->second;
+}
@@ -0,0 +1,55 @@
+/**********************************
+ * FILE NAME: Placement.h
+ *
+ * DESCRIPTION: Header file Placement class
+ **********************************/
+
+#ifndef PLACEMENT_H_
+#define PLACEMENT_H_
+
+/**
+ * Header files
+ */
+#include "stdincludes.h"
+#include "Params.h"
+#include "Node.h"
+#include "FlatHashMap.h"
+
+/**
+ * CLASS NAME: Placement
+ *
+ * DESCRIPTION: Strategy deciding which members replicate a key. Implementations get the
+ * 				membership list with a capacity per member (its virtual node count) and
+ * 				return the replica set of a key hash as indices into the member list, the
+ * 				preferred replica first.
+ */
+class Placement {
+protected:
+	// Physical nodes, in the order given to build()
+	vector<Node> members;
+	// Position in members, keyed by Member::memberKey(id, port)
+	FlatHashMap<long long, int> memberIndex;
+	// Length of each preference list
+	int replicas;
+	void setMembers(const vector<Node> &members, int replicas);
+
+public:
+	Placement();
+	static Placement * create(placementTYPE type);
+	virtual void build(const vector<Node> &members, const vector<int> &vnodes, int replicas) = 0;
+	/*
+	 * replicas distinct indices into the members (see member()), NULL if there are fewer
+	 * members than replicas. The list stays valid until the next call on this object.
+	 */
+	virtual const int * preferenceList(uint64_t hash) = 0;
+	int size() const {
+		return members.size();
+	}
+	Node & member(int index) {
+		return members[index];
+	}
+	int find(Address &address);
+	virtual ~Placement();
+};
+
+#endif /* PLACEMENT_H_ */
@@ -0,0 +1,70 @@
+/**********************************
+ * FILE NAME: Rendezvous.cpp
+ *
+ * DESCRIPTION: Rendezvous class definition
+ **********************************/
+
+#include "Rendezvous.h"
+
+/**
+ * constructor
+ */
+Rendezvous::Rendezvous() {}
+
+/**
+ * Destructor
+ */
+Rendezvous::~Rendezvous() {}
+
+/**
+ * FUNCTION NAME: build
+ *
+ * DESCRIPTION: Record the members with their seeds and weights
+ */
+void Rendezvous::build(const vector<Node> &members, const vector<int> &vnodes, int replicas) {
+	setMembers(members, replicas);
+	seeds.resize(members.size());
+	weights.resize(members.size());
+	for (unsigned int i = 0; i < members.size(); ++i) {
+		seeds[i] = this->members[i].computeToken(0);
+		weights[i] = vnodes[i];
+	}
+	scratch.resize(replicas);
+	scores.resize(replicas);
+}
+
+/**
+ * FUNCTION NAME: preferenceList
+ *
+ * DESCRIPTION: Replica set of the hash: the members with the highest scores, best first
+ * 				The score -weight / ln(u), u uniform in (0, 1) per (key, member), gives
+ * 				each member a share of the keys proportional to its weight
+ */
+const int * Rendezvous::preferenceList(uint64_t hash) {
+	if (members.empty() || (int)members.size() < replicas) {
+		return NULL;
+	}
+	int found = 0;
+	for (unsigned int i = 0; i < members.size(); ++i) {
+		uint64_t mixed = hashMix(hash ^ seeds[i]);
+		double u = ((mixed >> 11) + 0.5) / 9007199254740992.0;
+		double score = -weights[i] / log(u);
+		// insertion into the sorted top list
+		int pos = found;
+		while (pos > 0 && scores[pos - 1] < score) {
+			if (pos < replicas) {
+				scores[pos] = scores[pos - 1];
+				scratch[pos] = scratch[pos - 1];
+			}
+			--pos;
+		}
+		if (pos < replicas) {
+			scores[pos] = score;
+			scratch[pos] = i;
+			if (found < replicas) {
+				++found;
+			}
+		}
+	}
+	return &scratch[0];
+}
@@ -0,0 +1,41 @@
+/**********************************
+ * FILE NAME: Rendezvous.h
+ *
+ * DESCRIPTION: Header file Rendezvous class
+ **********************************/
+
+#ifndef RENDEZVOUS_H_
+#define RENDEZVOUS_H_
+
+/**
+ * Header files
+ */
+#include "stdincludes.h"
+#include "Placement.h"
+
+/**
+ * CLASS NAME: Rendezvous
+ *
+ * DESCRIPTION: Rendezvous (highest random weight) hashing. Every member scores the key
+ * 				and the highest scores replicate it, weighted by the member's vnode count.
+ * 				Only the keys of a removed member move, whatever its position, at the
+ * 				price of a lookup linear in the number of members.
+ */
+class Rendezvous: public Placement {
+private:
+	// Hash of each member's address
+	vector<uint64_t> seeds;
+	// Weight of each member
+	vector<double> weights;
+	// Preference list handed out by preferenceList(), and the scores of its entries
+	vector<int> scratch;
+	vector<double> scores;
+
+public:
+	Rendezvous();
+	void build(const vector<Node> &members, const vector<int> &vnodes, int replicas);
+	const int * preferenceList(uint64_t hash);
+	virtual ~Rendezvous();
+};
+
+#endif /* RENDEZVOUS_H_ */
@@ -0,0 +1,94 @@
+/**********************************
+ * FILE NAME: Ring.cpp
+ *
+ * DESCRIPTION: Ring class definition
+ **********************************/
+
+#include "Ring.h"
+
+/**
+ * constructor
+ */
+Ring::Ring() {}
+
+/**
+ * Destructor
+ */
+Ring::~Ring() {}
+
+/**
+ * FUNCTION NAME: build
+ *
+ * DESCRIPTION: Rebuild the ring from the membership list. members[i] gets vnodes[i] tokens.
+ * 				The preference list of a token is its owner followed by the next distinct
+ * 				members met walking clockwise from it.
+ */
+void Ring::build(const vector<Node> &members, const vector<int> &vnodes, int replicas) {
+	setMembers(members, replicas);
+	int size = members.size();
+
+	// place the virtual nodes, ties broken by member so every node builds the same ring
+	vector< pair<uint64_t, int> > placed;
+	for (int i = 0; i < size; ++i) {
+		for (int v = 0; v < vnodes[i]; ++v) {
+			placed.push_back(make_pair(this->members[i].computeToken(v), i));
+		}
+	}
+	sort(placed.begin(), placed.end());
+	int count = placed.size();
+	tokens.resize(count);
+	owners.resize(count);
+	for (int t = 0; t < count; ++t) {
+		tokens[t] = placed[t].first;
+		owners[t] = placed[t].second;
+	}
+
+	preference.clear();
+	if (size < replicas) {
+		return;
+	}
+	preference.resize(count * replicas);
+	for (int t = 0; t < count; ++t) {
+		int *list = &preference[t * replicas];
+		int found = 0;
+		for (int step = 0; step < count && found < replicas; ++step) {
+			int owner = owners[(t + step) % count];
+			if (std::find(list, list + found, owner) == list + found) {
+				list[found++] = owner;
+			}
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: lookup
+ *
+ * DESCRIPTION: Find the virtual node owning the hash: the first token >= hash, wrapping
+ * 				around to the smallest token past the end of the ring
+ *
+ * RETURNS:
+ * index of the token, -1 if the ring is empty
+ */
+int Ring::lookup(uint64_t hash) const {
+	if (tokens.empty()) {
+		return -1;
+	}
+	int index = lower_bound(tokens.begin(), tokens.end(), hash) - tokens.begin();
+	return index == (int)tokens.size() ? 0 : index;
+}
+
+/**
+ * FUNCTION NAME: preferenceList
+ *
+ * DESCRIPTION: Replica set of the hash
+ *
+ * RETURNS:
+ * replicas distinct indices into the members (see member()), NULL if the ring has fewer
+ * members than replicas
+ */
+const int * Ring::preferenceList(uint64_t hash) {
+	if (preference.empty()) {
+		return NULL;
+	}
+	return &preference[lookup(hash) * replicas];
+}
@@ -0,0 +1,45 @@
+/**********************************
+ * FILE NAME: Ring.h
+ *
+ * DESCRIPTION: Header file Ring class
+ **********************************/
+
+#ifndef RING_H_
+#define RING_H_
+
+/**
+ * Header files
+ */
+#include "stdincludes.h"
+#include "Placement.h"
+
+/**
+ * CLASS NAME: Ring
+ *
+ * DESCRIPTION: Consistent hashing ring on a 64-bit token space. Every physical node
+ * 				(member) owns several virtual nodes, each at its own token, so one member
+ * 				owns many small ranges. The preference list (the replica set) of every
+ * 				token holds distinct members and is computed when the ring is built, so a
+ * 				lookup is a binary search and allocates nothing.
+ */
+class Ring: public Placement {
+private:
+	// Sorted virtual node tokens
+	vector<uint64_t> tokens;
+	// Member owning tokens[i]
+	vector<int> owners;
+	// replicas entries per token: indices into members, the owner first
+	vector<int> preference;
+
+public:
+	Ring();
+	void build(const vector<Node> &members, const vector<int> &vnodes, int replicas);
+	int tokenCount() const {
+		return tokens.size();
+	}
+	int lookup(uint64_t hash) const;
+	const int * preferenceList(uint64_t hash);
+	virtual ~Ring();
+};
+
+#endif /* RING_H_ */
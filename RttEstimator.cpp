@@ -0,0 +1,126 @@
+/**********************************
+ * FILE NAME: RttEstimator.cpp
+ *
+ * DESCRIPTION: Definition of RttEstimator class
+ **********************************/
+
+#include "RttEstimator.h"
+
+/**
+ * FUNCTION NAME: keyOf
+ *
+ * DESCRIPTION: Key of the statistics of a replica and message type
+ */
+long long RttEstimator::keyOf(Address *replica, MessageType type) {
+	return Member::memberKey(*(int *)(&replica->addr), *(short *)(&replica->addr[4])) * 8 + type;
+}
+
+/**
+ * FUNCTION NAME: sample
+ *
+ * DESCRIPTION: Account a reply of replica that arrived rtt ticks after the request
+ */
+void RttEstimator::sample(Address *replica, MessageType type, long rtt) {
+	pair<FlatHashMap<long long, RttStats>::iterator, bool> inserted = stats.emplace(keyOf(replica, type), RttStats());
+	RttStats &entry = inserted.first->second;
+	if ( inserted.second ) {
+		entry.srtt = rtt;
+		entry.rttvar = rtt / 2.0;
+		entry.samples = 0;
+	}
+	else {
+		entry.rttvar = 0.75 * entry.rttvar + 0.25 * fabs(entry.srtt - rtt);
+		entry.srtt = 0.875 * entry.srtt + 0.125 * rtt;
+	}
+	entry.samples++;
+	entry.lastRtt = rtt;
+	entry.histogram[max(0L, min(rtt, (long)RTT_BUCKETS - 1))]++;
+	// a timeout shorter than a tick apart from the mean would fire on ordinary jitter
+	long rto = (long)ceil(entry.srtt + max(1.0, 4 * entry.rttvar));
+	entry.rto = max((long)RTO_MIN, min(rto, (long)RTO_MAX));
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Statistics of a replica and message type, NULL before the first sample
+ */
+RttStats *RttEstimator::find(Address *replica, MessageType type) {
+	FlatHashMap<long long, RttStats>::iterator iter = stats.find(keyOf(replica, type));
+	return iter == stats.end() ? NULL : &iter->second;
+}
+
+/**
+ * FUNCTION NAME: rto
+ *
+ * DESCRIPTION: Ticks to wait for a reply of replica
+ */
+long RttEstimator::rto(Address *replica, MessageType type) {
+	RttStats *entry = find(replica, type);
+	return entry ? entry->rto : RTO_INITIAL;
+}
+
+/**
+ * FUNCTION NAME: latency
+ *
+ * DESCRIPTION: Expected round-trip time of replica, RTO_INITIAL if it never answered
+ */
+double RttEstimator::latency(Address *replica, MessageType type) {
+	RttStats *entry = find(replica, type);
+	return entry ? entry->srtt : RTO_INITIAL;
+}
+
+/**
+ * FUNCTION NAME: percentile
+ *
+ * DESCRIPTION: Round-trip time that percent of the replies of replica arrived within
+ */
+long RttEstimator::percentile(Address *replica, MessageType type, int percent) {
+	RttStats *entry = find(replica, type);
+	if ( !entry ) {
+		return RTO_INITIAL;
+	}
+	long rank = max(1L, (entry->samples * percent + 99) / 100);
+	long seen = 0;
+	for ( int i = 0; i < RTT_BUCKETS; i++ ) {
+		seen += entry->histogram[i];
+		if ( seen >= rank ) {
+			return max(1, i);
+		}
+	}
+	return RTT_BUCKETS - 1;
+}
+
+/**
+ * FUNCTION NAME: quorumTimeout
+ *
+ * DESCRIPTION: Ticks to wait for quorum replies of the replicas, the quorum-th smallest RTO
+ */
+long RttEstimator::quorumTimeout(const vector<Address *> &replicas, MessageType type, int quorum) {
+	if ( replicas.empty() ) {
+		return RTO_INITIAL;
+	}
+	vector<long> rtos;
+	rtos.reserve(replicas.size());
+	for ( unsigned int i = 0; i < replicas.size(); i++ ) {
+		rtos.push_back(rto(replicas[i], type));
+	}
+	int k = max(1, min(quorum, (int)rtos.size())) - 1;
+	nth_element(rtos.begin(), rtos.begin() + k, rtos.end());
+	return rtos[k];
+}
+
+/**
+ * FUNCTION NAME: writeStats
+ *
+ * DESCRIPTION: Print one line per replica and message type seen by the coordinator self
+ */
+void RttEstimator::writeStats(FILE *file, Address *self) {
+	for ( FlatHashMap<long long, RttStats>::iterator iter = stats.begin(); iter != stats.end(); ++iter ) {
+		RttStats &entry = iter->second;
+		long long member = iter->first / 8;
+		fprintf(file, "coordinator %s replica %d:%d type %d samples %ld last %ld srtt %.2f rttvar %.2f rto %ld\n",
+				self->getAddress().c_str(), (int)(member >> 16), (int)(unsigned short)member, (int)(iter->first % 8),
+				entry.samples, entry.lastRtt, entry.srtt, entry.rttvar, entry.rto);
+	}
+}
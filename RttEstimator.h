@@ -0,0 +1,62 @@
+/**********************************
+ * FILE NAME: RttEstimator.h
+ *
+ * DESCRIPTION: Header file of RttEstimator class
+ **********************************/
+
+#ifndef RTTESTIMATOR_H_
+#define RTTESTIMATOR_H_
+
+#include "stdincludes.h"
+#include "FlatHashMap.h"
+#include "Member.h"
+#include "common.h"
+
+/**
+ * Macros
+ */
+// Retransmission timeout bounds in ticks, RTO_INITIAL is used until a replica answered once
+#define RTO_INITIAL 10
+#define RTO_MIN 4
+#define RTO_MAX 20
+// Round-trip histogram buckets, one per tick, the last one holds everything slower
+#define RTT_BUCKETS (RTO_MAX + 1)
+
+/**
+ * STRUCT NAME: RttStats
+ *
+ * DESCRIPTION: Round-trip statistics of one replica for one message type
+ */
+struct RttStats {
+	double srtt;		// smoothed round-trip time
+	double rttvar;		// smoothed mean deviation
+	long rto;			// timeout derived from both
+	long samples;
+	long lastRtt;
+	long histogram[RTT_BUCKETS];
+};
+
+/**
+ * CLASS NAME: RttEstimator
+ *
+ * DESCRIPTION: Per replica and MessageType round-trip times measured by a coordinator
+ * 				Samples are smoothed as in TCP (RFC 6298): srtt and rttvar are moving
+ * 				averages with gains 1/8 and 1/4, and RTO = srtt + 4 * rttvar clamped to
+ * 				[RTO_MIN, RTO_MAX]
+ */
+class RttEstimator {
+private:
+	FlatHashMap<long long, RttStats> stats;
+	static long long keyOf(Address *replica, MessageType type);
+
+public:
+	void sample(Address *replica, MessageType type, long rtt);
+	long rto(Address *replica, MessageType type);
+	double latency(Address *replica, MessageType type);
+	long percentile(Address *replica, MessageType type, int percent);
+	long quorumTimeout(const vector<Address *> &replicas, MessageType type, int quorum);
+	RttStats *find(Address *replica, MessageType type);
+	void writeStats(FILE *file, Address *self);
+};
+
+#endif /* RTTESTIMATOR_H_ */
@@ -0,0 +1,114 @@
+/**********************************
+ * FILE NAME: SlabPool.cpp
+ *
+ * DESCRIPTION: Definition of SlabPool class
+ **********************************/
+
+#include "SlabPool.h"
+
+/**
+ * Constructor
+ */
+SlabPool::SlabPool(): allocs(0), releases(0), poolHits(0), slabCount(0), oversize(0) {
+	for ( int i = 0; i < SLAB_CLASSES; i++ ) {
+		freeList[i] = NULL;
+	}
+}
+
+/**
+ * Destructor
+ */
+SlabPool::~SlabPool() {
+	for ( unsigned int i = 0; i < slabs.size(); i++ ) {
+		free(slabs[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: sizeClassOf
+ *
+ * DESCRIPTION: Smallest size class whose blocks fit size bytes
+ *
+ * RETURNS:
+ * class index, SLAB_OVERSIZE if none fits
+ */
+int SlabPool::sizeClassOf(int size) {
+	int sizeClass = 0;
+	int blockSize = SLAB_MIN_BLOCK;
+	while ( blockSize < size ) {
+		blockSize <<= 1;
+		sizeClass++;
+	}
+	return sizeClass < SLAB_CLASSES ? sizeClass : SLAB_OVERSIZE;
+}
+
+/**
+ * FUNCTION NAME: refill
+ *
+ * DESCRIPTION: Carve a new slab into blocks of the size class and push them on its free list
+ */
+void SlabPool::refill(int sizeClass) {
+	int stride = sizeof(BlockHeader) + (SLAB_MIN_BLOCK << sizeClass);
+	int count = max(1, SLAB_BYTES / stride);
+	char *slab = (char *) malloc(stride * count);
+	slabs.push_back(slab);
+	slabCount++;
+	for ( int i = count - 1; i >= 0; i-- ) {
+		BlockHeader *header = (BlockHeader *)(slab + i * stride);
+		header->next = freeList[sizeClass];
+		freeList[sizeClass] = header;
+	}
+}
+
+/**
+ * FUNCTION NAME: allocate
+ *
+ * DESCRIPTION: Hand out a buffer of at least size bytes
+ */
+void *SlabPool::allocate(int size) {
+	BlockHeader *header;
+	int sizeClass = sizeClassOf(size);
+	allocs++;
+	if ( sizeClass == SLAB_OVERSIZE ) {
+		oversize++;
+		header = (BlockHeader *) malloc(sizeof(BlockHeader) + size);
+	}
+	else {
+		if ( freeList[sizeClass] == NULL ) {
+			refill(sizeClass);
+		}
+		else {
+			poolHits++;
+		}
+		header = freeList[sizeClass];
+		freeList[sizeClass] = header->next;
+	}
+	header->sizeClass = sizeClass;
+	return header + 1;
+}
+
+/**
+ * FUNCTION NAME: release
+ *
+ * DESCRIPTION: Give a buffer obtained from allocate back to its free list
+ */
+void SlabPool::release(void *block) {
+	BlockHeader *header = (BlockHeader *)block - 1;
+	int sizeClass = header->sizeClass;
+	releases++;
+	if ( sizeClass == SLAB_OVERSIZE ) {
+		free(header);
+		return;
+	}
+	header->next = freeList[sizeClass];
+	freeList[sizeClass] = header;
+}
+
+/**
+ * FUNCTION NAME: inUse
+ *
+ * DESCRIPTION: Number of buffers handed out and not yet released
+ */
+unsigned long SlabPool::inUse() {
+	return allocs - releases;
+}
@@ -0,0 +1,63 @@
+/**********************************
+ * FILE NAME: SlabPool.h
+ *
+ * DESCRIPTION: Header file of SlabPool class
+ **********************************/
+
+#ifndef SLABPOOL_H_
+#define SLABPOOL_H_
+
+#include "stdincludes.h"
+
+/**
+ * Macros
+ */
+// Block sizes are powers of two from SLAB_MIN_BLOCK to SLAB_MAX_BLOCK bytes
+#define SLAB_MIN_BLOCK 64
+#define SLAB_MAX_BLOCK 4096
+#define SLAB_CLASSES 7
+// Bytes carved into blocks each time a size class runs dry
+#define SLAB_BYTES 16384
+// Class tag of blocks too large for any size class
+#define SLAB_OVERSIZE -1
+
+/**
+ * CLASS NAME: SlabPool
+ *
+ * DESCRIPTION: Size-classed pool of recycled buffers
+ * 				Each class keeps a free list of fixed-size blocks carved out of larger slabs.
+ * 				Released blocks go back to their free list and are never returned to the
+ * 				system until the pool is destroyed. Requests larger than SLAB_MAX_BLOCK fall
+ * 				back to malloc/free.
+ */
+class SlabPool {
+private:
+	// header in front of every block, remembers where the block goes back to
+	union BlockHeader {
+		int sizeClass;
+		BlockHeader *next;
+		// keeps the payload 8-byte aligned
+		double align;
+	};
+	BlockHeader *freeList[SLAB_CLASSES];
+	vector<void *> slabs;
+	SlabPool(const SlabPool &anotherPool);
+	SlabPool& operator = (const SlabPool &anotherPool);
+	int sizeClassOf(int size);
+	void refill(int sizeClass);
+
+public:
+	// allocation counters
+	unsigned long allocs;			// blocks handed out
+	unsigned long releases;			// blocks given back
+	unsigned long poolHits;			// allocations served without asking the system for memory
+	unsigned long slabCount;		// slabs obtained from the system
+	unsigned long oversize;			// allocations that bypassed the pool
+	SlabPool();
+	virtual ~SlabPool();
+	void *allocate(int size);
+	void release(void *block);
+	unsigned long inUse();
+};
+
+#endif /* SLABPOOL_H_ */
@@ -0,0 +1,85 @@
+/**********************************
+ * FILE NAME: TimingWheel.cpp
+ *
+ * DESCRIPTION: Definition of TimingWheel class
+ **********************************/
+
+#include "TimingWheel.h"
+
+/**
+ * Constructor
+ */
+TimingWheel::TimingWheel(): now(0), count(0) {}
+
+/**
+ * FUNCTION NAME: place
+ *
+ * DESCRIPTION: Put the timer in the level matching its distance from now
+ */
+void TimingWheel::place(const TimerEntry &timer) {
+	long delta = timer.deadline - now;
+	if ( delta <= 0 ) {
+		due.push_back(timer);
+	}
+	else if ( delta < WHEEL_SLOTS ) {
+		level0[timer.deadline & WHEEL_MASK].push_back(timer);
+	}
+	else if ( delta < WHEEL_SLOTS * WHEEL_SLOTS ) {
+		level1[(timer.deadline >> WHEEL_BITS) & WHEEL_MASK].push_back(timer);
+	}
+	else {
+		overflow.push_back(timer);
+	}
+}
+
+/**
+ * FUNCTION NAME: cascade
+ *
+ * DESCRIPTION: Empty a slot of an upper level and place its timers again
+ */
+void TimingWheel::cascade(vector<TimerEntry> &slot) {
+	vector<TimerEntry> timers;
+	timers.swap(slot);
+	for ( unsigned int i = 0; i < timers.size(); i++ ) {
+		place(timers[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: schedule
+ *
+ * DESCRIPTION: Fire id once the wheel advances to deadline
+ */
+void TimingWheel::schedule(int id, long deadline) {
+	TimerEntry timer = {id, deadline};
+	place(timer);
+	count++;
+}
+
+/**
+ * FUNCTION NAME: advance
+ *
+ * DESCRIPTION: Move the wheel forward to time and append the timers that fired to expired
+ */
+void TimingWheel::advance(long time, vector<TimerEntry> &expired) {
+	count -= due.size();
+	expired.insert(expired.end(), due.begin(), due.end());
+	due.clear();
+	while ( now < time ) {
+		now++;
+		if ( (now & WHEEL_MASK) == 0 ) {
+			if ( ((now >> WHEEL_BITS) & WHEEL_MASK) == 0 ) {
+				cascade(overflow);
+			}
+			cascade(level1[(now >> WHEEL_BITS) & WHEEL_MASK]);
+		}
+		vector<TimerEntry> &slot = level0[now & WHEEL_MASK];
+		count -= slot.size();
+		expired.insert(expired.end(), slot.begin(), slot.end());
+		slot.clear();
+		// cascading can land timers of this very tick in the due list
+		count -= due.size();
+		expired.insert(expired.end(), due.begin(), due.end());
+		due.clear();
+	}
+}
@@ -0,0 +1,62 @@
+/**********************************
+ * FILE NAME: TimingWheel.h
+ *
+ * DESCRIPTION: Header file of TimingWheel class
+ **********************************/
+
+#ifndef TIMINGWHEEL_H_
+#define TIMINGWHEEL_H_
+
+#include "stdincludes.h"
+
+/**
+ * Macros
+ */
+// Slots per level, a power of two; level 0 has one slot per tick, level 1 one per WHEEL_SLOTS ticks
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+/**
+ * STRUCT NAME: TimerEntry
+ *
+ * DESCRIPTION: Timer of the object id that fires at tick deadline
+ */
+struct TimerEntry {
+	int id;
+	long deadline;
+};
+
+/**
+ * CLASS NAME: TimingWheel
+ *
+ * DESCRIPTION: Two-level hierarchical timing wheel
+ * 				Level 0 covers the next WHEEL_SLOTS ticks, level 1 the next WHEEL_SLOTS^2 ticks,
+ * 				later deadlines wait in an overflow list. Timers move down a level when the
+ * 				wheel above turns, so advancing costs O(expired) plus the cascades.
+ * 				Timers are never removed: the owner checks whether a fired timer is still
+ * 				wanted (lazy cancellation), and can reschedule by adding a later timer.
+ */
+class TimingWheel {
+private:
+	// last tick the wheel advanced to
+	long now;
+	vector<TimerEntry> level0[WHEEL_SLOTS];
+	vector<TimerEntry> level1[WHEEL_SLOTS];
+	vector<TimerEntry> overflow;
+	// timers scheduled at or before now, fire on the next advance
+	vector<TimerEntry> due;
+	size_t count;
+	void place(const TimerEntry &timer);
+	void cascade(vector<TimerEntry> &slot);
+
+public:
+	TimingWheel();
+	void schedule(int id, long deadline);
+	void advance(long time, vector<TimerEntry> &expired);
+	size_t pending() {
+		return count;
+	}
+};
+
+#endif /* TIMINGWHEEL_H_ */
@@ -0,0 +1,169 @@
+/**********************************
+ * FILE NAME: Transaction.cpp
+ *
+ * DESCRIPTION: Definition of Transaction class
+ **********************************/
+
+#include "Transaction.h"
+#include "Hash.h"
+
+/**
+ * Constructor
+ */
+Transaction::Transaction(): transID(0), type(CREATE), issued(0), deadline(0), repairDeadline(0), expected(0), quorum(0), state(TRANS_PENDING), received(0), nextSpare(0), hedgeAt(-1), hedgeWon(false), completed(-1), fetching(false), unreported(0), next(NULL) {}
+
+/**
+ * FUNCTION NAME: reset
+ *
+ * DESCRIPTION: Start a new transaction in this record
+ */
+void Transaction::reset(int transID, MessageType type, const string &key, const string &value, long issued, long deadline, int expected, int quorum) {
+	this->transID = transID;
+	this->type = type;
+	this->key.assign(key);
+	this->value.assign(value);
+	this->issued = issued;
+	this->deadline = deadline;
+	this->repairDeadline = deadline;
+	this->expected = expected;
+	this->quorum = quorum;
+	this->state = TRANS_PENDING;
+	this->received = 0;
+	this->spares.clear();
+	this->nextSpare = 0;
+	this->hedgeAt = -1;
+	this->hedgeWon = false;
+	this->completed = -1;
+	this->fetching = false;
+	this->keys.clear();
+	this->unreported = 0;
+}
+
+/**
+ * FUNCTION NAME: addReply
+ *
+ * DESCRIPTION: Record a REPLY or READREPLY, copying the value out of the receive buffer
+ */
+void Transaction::addReply(const MessageView &msg) {
+	TransReply &reply = nextReply();
+	reply.from = msg.fromAddr;
+	reply.success = msg.success;
+	reply.full = !msg.digestOnly;
+	reply.version = msg.version;
+	reply.value.assign(msg.value.data, msg.value.size);
+	reply.digest = msg.digestOnly ? msg.digest : valueDigest(msg.value.data, msg.value.size);
+}
+
+/**
+ * FUNCTION NAME: addReply
+ *
+ * DESCRIPTION: Record the reply of the coordinator's own replica, served without the network
+ */
+void Transaction::addReply(const Message &msg) {
+	TransReply &reply = nextReply();
+	reply.from = msg.fromAddr;
+	reply.success = msg.success;
+	reply.full = !msg.digestOnly;
+	reply.version = msg.version;
+	reply.value.assign(msg.value);
+	reply.digest = msg.digestOnly ? msg.digest : valueDigest(msg.value.data(), msg.value.size());
+}
+
+/**
+ * FUNCTION NAME: addKey
+ *
+ * DESCRIPTION: Track one more key of a batch transaction
+ *
+ * RETURNS:
+ * index of the key, sent in its sub-operations
+ */
+int Transaction::addKey(MessageType type, const string &key, const string &value, int expected) {
+	BatchKey entry;
+	entry.type = type;
+	entry.key = key;
+	entry.value = value;
+	entry.expected = expected;
+	entry.received = 0;
+	entry.succeeded = 0;
+	entry.version = Version();
+	entry.reported = false;
+	keys.push_back(entry);
+	++unreported;
+	return keys.size() - 1;
+}
+
+/**
+ * FUNCTION NAME: addBatchReply
+ *
+ * DESCRIPTION: Record the results of a BATCHREPLY on the keys they belong to,
+ * 				a read keeps the value of the newest version
+ */
+void Transaction::addBatchReply(const Message &msg) {
+	for ( const BatchOp &op : msg.ops ) {
+		if ( op.index < 0 || op.index >= (int)keys.size() ) {
+			continue;
+		}
+		BatchKey &entry = keys[op.index];
+		++entry.received;
+		if ( !op.success ) {
+			continue;
+		}
+		if ( entry.type == READ && (entry.succeeded == 0 || entry.version < op.version) ) {
+			entry.value = op.value;
+			entry.version = op.version;
+		}
+		++entry.succeeded;
+	}
+}
+
+/**
+ * FUNCTION NAME: nextReply
+ *
+ * DESCRIPTION: Slot of the next reply, reusing the slots of the previous transactions
+ */
+TransReply &Transaction::nextReply() {
+	if ( received == (int)replies.size() ) {
+		replies.push_back(TransReply());
+	}
+	return replies[received++];
+}
+
+/**
+ * FUNCTION NAME: addSpare
+ *
+ * DESCRIPTION: Keep a replica to hedge to if the replicas asked first are late
+ */
+void Transaction::addSpare(Address *addr) {
+	TransSpare spare;
+	spare.addr = *addr;
+	spare.sentAt = -1;
+	spares.push_back(spare);
+}
+
+/**
+ * FUNCTION NAME: sentTime
+ *
+ * DESCRIPTION: Time the request was sent to addr, later than issued for hedged replicas
+ */
+long Transaction::sentTime(Address *addr) {
+	for ( int i = 0; i < nextSpare; i++ ) {
+		if ( spares[i].addr == *addr ) {
+			return spares[i].sentAt;
+		}
+	}
+	return issued;
+}
+
+/**
+ * FUNCTION NAME: repliedByHedge
+ *
+ * DESCRIPTION: Whether one of the replies received so far came from a hedged replica
+ */
+bool Transaction::repliedByHedge() {
+	for ( int i = 0; i < received; i++ ) {
+		if ( sentTime(&replies[i].from) != issued ) {
+			return true;
+		}
+	}
+	return false;
+}
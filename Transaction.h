@@ -0,0 +1,121 @@
+/**********************************
+ * FILE NAME: Transaction.h
+ *
+ * DESCRIPTION: Header file of Transaction class
+ **********************************/
+
+#ifndef TRANSACTION_H_
+#define TRANSACTION_H_
+
+#include "stdincludes.h"
+#include "Member.h"
+#include "Message.h"
+
+// progress of a transaction: waiting for its outcome, or outcome logged and only
+// waiting for the remaining replies (read repair)
+enum TransState {TRANS_PENDING, TRANS_REPORTED};
+
+/**
+ * STRUCT NAME: TransReply
+ *
+ * DESCRIPTION: Reply of one replica to a transaction
+ */
+struct TransReply {
+	Address from;
+	bool success;
+	// full is false for a digest reply, which leaves value empty
+	bool full;
+	uint64_t digest;
+	Version version;
+	string value;
+};
+
+/**
+ * STRUCT NAME: TransSpare
+ *
+ * DESCRIPTION: Replica a speculative read may hedge to, sentAt is -1 until it is asked
+ */
+struct TransSpare {
+	Address addr;
+	long sentAt;
+};
+
+/**
+ * STRUCT NAME: BatchKey
+ *
+ * DESCRIPTION: Progress of one key of a batch transaction
+ */
+struct BatchKey {
+	MessageType type;
+	string key;
+	string value;
+	// replies expected and received, and how many of them succeeded (had the key for a read)
+	int expected;
+	int received;
+	int succeeded;
+	// newest version read so far, a read copies its value
+	Version version;
+	bool reported;
+};
+
+/**
+ * CLASS NAME: Transaction
+ *
+ * DESCRIPTION: In-flight request of a coordinator with the typed replies received so far
+ * 				Records are recycled by TransactionTable, so reset() keeps the capacity
+ * 				of the strings and of the reply slots for the next transaction
+ */
+class Transaction {
+public:
+	int transID;
+	MessageType type;
+	string key;
+	string value;
+	// local time the request was sent and the time it fails unless it completed
+	long issued;
+	long deadline;
+	// time the slowest reply is expected, a read stays open until then to repair the replicas
+	long repairDeadline;
+	// replies expected and replies needed for success
+	int expected;
+	int quorum;
+	TransState state;
+	// replies[0 .. received) are valid, the slots after it are kept for reuse
+	vector<TransReply> replies;
+	int received;
+	// speculative reads: replicas not asked yet (spares[0 .. nextSpare) were hedged to),
+	// the time of the next hedge and whether a hedge reply completed the read
+	vector<TransSpare> spares;
+	int nextSpare;
+	long hedgeAt;
+	bool hedgeWon;
+	// time the outcome was logged
+	long completed;
+	// digest reads: the replicas agreed on a digest and its value was asked from fetchFrom
+	bool fetching;
+	Address fetchFrom;
+	// batch transactions: the keys by their index in the BATCH sub-operations and
+	// how many of them still wait for their outcome
+	vector<BatchKey> keys;
+	int unreported;
+	// next free record while in the pool
+	Transaction *next;
+
+	Transaction();
+	void reset(int transID, MessageType type, const string &key, const string &value, long issued, long deadline, int expected, int quorum);
+	void addReply(const MessageView &msg);
+	void addReply(const Message &msg);
+	int addKey(MessageType type, const string &key, const string &value, int expected);
+	void addBatchReply(const Message &msg);
+	void addSpare(Address *addr);
+	long sentTime(Address *addr);
+	bool repliedByHedge();
+	int remaining() {
+		return expected - received;
+	}
+
+private:
+	TransReply &nextReply();
+};
+
+#endif /* TRANSACTION_H_ */
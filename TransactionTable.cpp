@@ -0,0 +1,76 @@
+/**********************************
+ * FILE NAME: TransactionTable.cpp
+ *
+ * DESCRIPTION: Definition of TransactionTable class
+ **********************************/
+
+#include "TransactionTable.h"
+
+/**
+ * Constructor
+ */
+TransactionTable::TransactionTable(): freeList(NULL) {}
+
+/**
+ * Destructor
+ */
+TransactionTable::~TransactionTable() {
+	for ( unsigned int i = 0; i < slabs.size(); i++ ) {
+		delete [] slabs[i];
+	}
+}
+
+/**
+ * FUNCTION NAME: refill
+ *
+ * DESCRIPTION: Allocate a slab of records and push them on the free list
+ */
+void TransactionTable::refill() {
+	Transaction *slab = new Transaction[TRANS_SLAB];
+	slabs.push_back(slab);
+	for ( int i = TRANS_SLAB - 1; i >= 0; i-- ) {
+		slab[i].next = freeList;
+		freeList = &slab[i];
+	}
+}
+
+/**
+ * FUNCTION NAME: open
+ *
+ * DESCRIPTION: Take a record from the pool and register it under transID
+ */
+Transaction *TransactionTable::open(int transID, MessageType type, const string &key, const string &value, long issued, long deadline, int expected, int quorum) {
+	if ( !freeList ) {
+		refill();
+	}
+	Transaction *trans = freeList;
+	freeList = trans->next;
+	trans->next = NULL;
+	trans->reset(transID, type, key, value, issued, deadline, expected, quorum);
+	index[transID] = trans;
+	return trans;
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: In-flight transaction with the given id
+ *
+ * RETURNS:
+ * the record, NULL if the transaction is closed or unknown
+ */
+Transaction *TransactionTable::find(int transID) {
+	iterator iter = index.find(transID);
+	return iter == index.end() ? NULL : iter->second;
+}
+
+/**
+ * FUNCTION NAME: close
+ *
+ * DESCRIPTION: Unregister the transaction and give its record back to the pool
+ */
+void TransactionTable::close(Transaction *trans) {
+	index.erase(trans->transID);
+	trans->next = freeList;
+	freeList = trans;
+}
@@ -0,0 +1,54 @@
+/**********************************
+ * FILE NAME: TransactionTable.h
+ *
+ * DESCRIPTION: Header file of TransactionTable class
+ **********************************/
+
+#ifndef TRANSACTIONTABLE_H_
+#define TRANSACTIONTABLE_H_
+
+#include "stdincludes.h"
+#include "FlatHashMap.h"
+#include "Transaction.h"
+
+/**
+ * Macros
+ */
+// Records allocated at once when the pool runs dry
+#define TRANS_SLAB 64
+
+/**
+ * CLASS NAME: TransactionTable
+ *
+ * DESCRIPTION: In-flight transactions of a coordinator, indexed by transID
+ * 				Records come from slabs of TRANS_SLAB and go back to a free list when the
+ * 				transaction closes, they are never freed until the table is destroyed
+ */
+class TransactionTable {
+private:
+	FlatHashMap<int, Transaction *> index;
+	Transaction *freeList;
+	vector<Transaction *> slabs;
+	TransactionTable(const TransactionTable &anotherTable);
+	TransactionTable& operator = (const TransactionTable &anotherTable);
+	void refill();
+
+public:
+	typedef FlatHashMap<int, Transaction *>::iterator iterator;
+	TransactionTable();
+	virtual ~TransactionTable();
+	Transaction *open(int transID, MessageType type, const string &key, const string &value, long issued, long deadline, int expected, int quorum);
+	Transaction *find(int transID);
+	void close(Transaction *trans);
+	iterator begin() {
+		return index.begin();
+	}
+	iterator end() {
+		return index.end();
+	}
+	size_t size() {
+		return index.size();
+	}
+};
+
+#endif /* TRANSACTIONTABLE_H_ */
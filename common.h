@@ -7,9 +7,31 @@
 // Transaction Id
 static int g_transID = 0;
 
-// message types, reply is the message from node to coordinator
-enum MessageType {CREATE, READ, UPDATE, DELETE, REPLY, READREPLY};
-// enum of replica types
-enum ReplicaType {PRIMARY, SECONDARY, TERTIARY, RESERVED};
+// message types, reply is the message from node to coordinator,
+// a batch carries many sub-operations and its reply one result per sub-operation,
+// an envelope carries messages to the same node coalesced in one network message
+enum MessageType {CREATE, READ, UPDATE, DELETE, REPLY, READREPLY, BATCH, BATCHREPLY, ENVELOPE};
+// enum of replica types, replica i of the preference list has type i, RESERVED means none
+enum ReplicaType {PRIMARY, SECONDARY, TERTIARY, RESERVED = 255};
+
+// Hybrid logical clock stamp of a write: simulated wall time, logical counter and writer id.
+// Stamps of different coordinators compare, the all-zero stamp is older than any write
+struct Version {
+	long wall;
+	int logical;
+	int node;
+};
+
+inline bool operator <(const Version &a, const Version &b) {
+	if (a.wall != b.wall)
+		return a.wall < b.wall;
+	if (a.logical != b.logical)
+		return a.logical < b.logical;
+	return a.node < b.node;
+}
+
+inline bool operator ==(const Version &a, const Version &b) {
+	return a.wall == b.wall && a.logical == b.logical && a.node == b.node;
+}
 
 #endif
@@ -10,7 +10,6 @@
 /*
  * Macros
  */
-#define RING_SIZE 512
 #define FAILURE -1
 #define SUCCESS 0
 
@@ -35,6 +34,7 @@
 #include <string>
 #include <algorithm>
 #include <queue>
+#include <deque>
 #include <fstream>
 
 using namespace std;